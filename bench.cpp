@@ -0,0 +1,270 @@
+#include "screencanvas.hpp"
+
+#include <memory>
+#include <string>
+
+// Benchmarks of parsing input, encoding output and presenting frames, all through a MemoryIo so that no terminal is
+// needed. Each result is printed as one JSON object per line. Give group names as arguments to only run those.
+
+static const unsigned int ITERATIONS = 1000000;
+static const unsigned int PARSE_BYTES = 64 * 1024 * 1024;
+static const unsigned int FRAMES = 2000;
+static const Size FRAME_SIZE{50, 160};
+
+static int groupCount;
+static char** groups;
+
+static bool enabled(char const* group) {
+        if (groupCount == 0) return true;
+        for (int i = 0; i < groupCount; i++) {
+                if (strcmp(groups[i], group) == 0) return true;
+        }
+        return false;
+}
+
+static void report(char const* group, char const* name, uint64_t ops, uint64_t startTime, uint64_t bytes) {
+        uint64_t nanos = Terminal::monotonicNanos() - startTime;
+        printf("{\"group\": \"%s\", \"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.2f, \"bytes_per_op\": %.2f, \"mb_per_s\": %.2f}\n",
+                        group, name, (unsigned long long) ops, double(nanos) / ops, double(bytes) / ops, bytes * 1000.0 / nanos);
+        fflush(stdout);
+}
+
+static void appendFormatted(OutputBuffer& buffer, char const* fmt, ...) {
+        va_list argp;
+        va_start(argp, fmt);
+        buffer.appendFormatted(fmt, argp);
+        va_end(argp);
+}
+
+/** The same CUP followed by a foreground SGR formatted with printf and encoded with the Csi encoder. */
+static void benchCsi() {
+        OutputBuffer buffer;
+        FILE* devNull = fopen("/dev/null", "w");
+        if (devNull == nullptr) {
+                perror("fopen(/dev/null)");
+                exit(1);
+        }
+
+        size_t bytes = 0;
+        uint64_t startTime = Terminal::monotonicNanos();
+        for (unsigned int i = 0; i < ITERATIONS; i++) {
+                bytes += fprintf(devNull, "\033[%u;%uH", i % 200 + 1, i % 80 + 1);
+                bytes += fprintf(devNull, "\033[%dm", 30 + int(i % 8));
+        }
+        fflush(devNull);
+        report("csi", "fprintf", ITERATIONS, startTime, bytes);
+
+        bytes = 0;
+        startTime = Terminal::monotonicNanos();
+        for (unsigned int i = 0; i < ITERATIONS; i++) {
+                appendFormatted(buffer, "\033[%u;%uH", i % 200 + 1, i % 80 + 1);
+                appendFormatted(buffer, "\033[%dm", 30 + int(i % 8));
+                if (buffer.size() > 64 * 1024) {
+                        bytes += buffer.size();
+                        buffer.clear();
+                }
+        }
+        bytes += buffer.size();
+        buffer.clear();
+        report("csi", "vsnprintf", ITERATIONS, startTime, bytes);
+
+        bytes = 0;
+        startTime = Terminal::monotonicNanos();
+        for (unsigned int i = 0; i < ITERATIONS; i++) {
+                buffer.appendSequence<Csi::CUP>(i % 200 + 1, i % 80 + 1);
+                buffer.appendSequence<Csi::SGR>(30 + i % 8);
+                if (buffer.size() > 64 * 1024) {
+                        bytes += buffer.size();
+                        buffer.clear();
+                }
+        }
+        bytes += buffer.size();
+        buffer.clear();
+        report("csi", "encoder", ITERATIONS, startTime, bytes);
+
+        fclose(devNull);
+}
+
+/** Feed input made of the given pieces repeated until PARSE_BYTES, reporting the time per event. */
+static void benchParse(char const* name, std::initializer_list<char const*> pieces, bool textRuns) {
+        std::string chunk;
+        while (chunk.size() < 64 * 1024) {
+                for (char const* piece : pieces) chunk += piece;
+        }
+
+        MemoryIo io;
+        io.setKeepOutput(false);
+        Terminal terminal(io);
+        terminal.setTextRuns(textRuns).setBracketedPasteMode(true);
+        uint64_t events = 0;
+        uint64_t bytes = 0;
+        uint64_t startTime = Terminal::monotonicNanos();
+        while (bytes < PARSE_BYTES) {
+                io.feed(chunk.data(), chunk.size());
+                bytes += chunk.size();
+                while (terminal.await() != EventType::TIMEOUT) events++;
+        }
+        report("parse", name, events, startTime, bytes);
+}
+
+static void benchParsers() {
+        benchParse("keys", {"a", "\033[A", "\033[B", "\033OP", "\033[15~", "\r", "\177", "\033[1;5C"}, false);
+        benchParse("modified_keys", {"\033[1;5A", "\033[3;2~", "\033[27;5;13~", "\033x", "\033[97;7u", "\033O5P", "\033[H"}, false);
+        benchParse("mouse_sgr", {"\033[<0;12;5M", "\033[<0;12;5m", "\033[<35;120;40M", "\033[<64;3;4M"}, false);
+        benchParse("paste", {"\033[200~", "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor\n",
+                        "incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud\n", "\033[201~"}, false);
+        benchParse("utf8_chars", {"hello ", "wörld ", "日本語 ", "😀 ", "\r", "\033[D"}, false);
+        benchParse("utf8_text_runs", {"hello ", "wörld ", "日本語 ", "😀 ", "\r", "\033[D"}, true);
+}
+
+/** Call a Terminal method in immediate mode ITERATIONS times, reporting the time and output per call. */
+template <typename Operation>
+static void benchEncode(char const* name, Operation const& operation) {
+        MemoryIo io;
+        io.setKeepOutput(false);
+        Terminal terminal(io);
+        terminal.setCapability(Capability::TRUE_COLOR, true);
+        uint64_t bytesBefore = io.bytesWritten();
+        uint64_t startTime = Terminal::monotonicNanos();
+        for (unsigned int i = 0; i < ITERATIONS; i++) operation(terminal, i);
+        terminal.flush();
+        report("encode", name, ITERATIONS, startTime, io.bytesWritten() - bytesBefore);
+}
+
+static void benchEncoders() {
+        benchEncode("placeCursor", [](Terminal& t, unsigned int i) { t.placeCursor(i % 80, i % 24); });
+        benchEncode("moveCursor", [](Terminal& t, unsigned int i) { t.moveCursor(int(i % 7) - 3, int(i % 5) - 2); });
+        benchEncode("print_literal", [](Terminal& t, unsigned int) { t.print("status: ok"); });
+        benchEncode("print_formatted", [](Terminal& t, unsigned int i) { t.print("%u%%", i); });
+        benchEncode("printClipped", [](Terminal& t, unsigned int) { t.placeCursorAtColumn(70).printClipped(8, "日本語のテキスト"); });
+        benchEncode("setForeground", [](Terminal& t, unsigned int i) { t.setForeground(Color(i % 8)).print("x"); });
+        benchEncode("setForegroundIndexed", [](Terminal& t, unsigned int i) { t.setForegroundIndexed(uint8_t(i)).print("x"); });
+        benchEncode("setBackgroundRgb", [](Terminal& t, unsigned int i) { t.setBackgroundRgb(uint8_t(i), uint8_t(i >> 8), 40).print("x"); });
+        benchEncode("setAttribute", [](Terminal& t, unsigned int i) { t.setAttribute(Attribute(i % 4), (i / 4) % 2).print("x"); });
+        benchEncode("erase", [](Terminal& t, unsigned int i) { t.erase(1 + i % 40); });
+        benchEncode("insertLines", [](Terminal& t, unsigned int i) { t.insertLines(1 + i % 3); });
+        benchEncode("deleteCells", [](Terminal& t, unsigned int i) { t.deleteCells(1 + i % 3); });
+        benchEncode("fillRectangle", [](Terminal& t, unsigned int i) { t.fillRectangle(i % 40, i % 10, 20, 5, '#'); });
+        benchEncode("setTitle", [](Terminal& t, unsigned int i) { t.setTitle("build %u", i); });
+}
+
+/** Present FRAMES frames drawn by the given function, reporting the time and output per frame. */
+template <typename Draw>
+static void benchFrames(char const* name, bool capabilities, Draw const& draw) {
+        MemoryIo io(FRAME_SIZE);
+        io.setKeepOutput(false);
+        Terminal terminal(io);
+        for (Capability capability : {Capability::BACKGROUND_COLOR_ERASE, Capability::REPEAT, Capability::RECTANGULAR_EDITING}) {
+                terminal.setCapability(capability, capabilities);
+        }
+        terminal.setCapability(Capability::TRUE_COLOR, true);
+        terminal.setRetainedMode(true).hideCursor().clear();
+        // Leave out drawing the first frame on the blank screen.
+        draw(terminal, 0);
+        terminal.present().flush();
+
+        uint64_t bytesBefore = io.bytesWritten();
+        uint64_t startTime = Terminal::monotonicNanos();
+        for (unsigned int frame = 0; frame < FRAMES; frame++) {
+                terminal.resetColorsAndStyle().clear();
+                draw(terminal, frame);
+                terminal.present().flush();
+        }
+        std::string fullName = std::string(name) + (capabilities ? "+capabilities" : "");
+        report("frame", fullName.c_str(), FRAMES, startTime, io.bytesWritten() - bytesBefore);
+}
+
+static void drawText(Terminal& t, unsigned int frame) {
+        for (unsigned int row = 0; row < t.rows(); row++) {
+                t.placeCursor(0, row).print("%4u  The quick brown fox jumps over the lazy dog, line %u of the document.", row, row + frame / 1000);
+        }
+}
+
+static void benchFrameScenarios() {
+        for (bool capabilities : {false, true}) {
+                benchFrames("idle", capabilities, [](Terminal& t, unsigned int) { drawText(t, 0); });
+                benchFrames("clock", capabilities, [](Terminal& t, unsigned int frame) {
+                        drawText(t, 0);
+                        t.placeCursor(t.columns() - 10, t.rows() - 1).setAttribute(Attribute::BOLD, true).print("%02u:%02u:%02u", frame / 3600 % 24, frame / 60 % 60, frame % 60);
+                });
+                benchFrames("full_redraw", capabilities, [](Terminal& t, unsigned int frame) {
+                        for (unsigned int row = 0; row < t.rows(); row++) {
+                                t.placeCursor(0, row);
+                                for (unsigned int column = 0; column < t.columns(); column++) t.print("%c", 'a' + (row * 7 + column * 3 + frame) % 26);
+                        }
+                });
+                benchFrames("scroll", capabilities, [](Terminal& t, unsigned int frame) {
+                        for (unsigned int row = 0; row < t.rows(); row++) {
+                                unsigned int line = frame + (t.rows() - 1 - row);
+                                t.placeCursor(0, row).setForeground(Color(1 + line % 7)).print("[%8u] request handled in %u ms", line, line * 37 % 500);
+                        }
+                });
+                benchFrames("gradient", capabilities, [](Terminal& t, unsigned int frame) {
+                        for (unsigned int row = 0; row < t.rows(); row++) {
+                                t.placeCursor(0, row);
+                                for (unsigned int column = 0; column < t.columns(); column++) {
+                                        t.setBackgroundRgb(uint8_t(column + frame), uint8_t(row * 4), 128).print(" ");
+                                }
+                        }
+                });
+                benchFrames("unicode", capabilities, [](Terminal& t, unsigned int frame) {
+                        for (unsigned int row = 0; row < t.rows(); row++) {
+                                t.placeCursor(0, row).print("%u 日本語のテキスト ü é 😀 👍🏽 🇸🇪 línea %u", row, (row + frame) % 10);
+                        }
+                });
+                benchFrames("fill_rectangles", capabilities, [](Terminal& t, unsigned int frame) {
+                        t.setBackground(Color::BLUE).fillRectangle(frame % 40, 5, 60, 20, ' ');
+                        t.setBackground(Color::DEFAULT).setForeground(Color::YELLOW).fillRectangle(100, frame % 20, 40, 10, '#');
+                });
+        }
+}
+
+/** A dashboard of twelve panes on canvases with a popup in front, where each frame redraws one pane or moves the popup,
+ * so that only that is composited and presented. */
+static void benchCanvases(char const* name, bool movePopup) {
+        MemoryIo io(FRAME_SIZE);
+        io.setKeepOutput(false);
+        Terminal terminal(io);
+        terminal.setCapability(Capability::RECTANGULAR_EDITING, true).setCapability(Capability::REPEAT, true);
+        terminal.setRetainedMode(true).hideCursor().clear();
+        unsigned int columns = FRAME_SIZE.columns / 4, rows = FRAME_SIZE.rows / 3;
+        std::vector<std::unique_ptr<Canvas>> panes;
+        auto drawPane = [&](unsigned int pane, unsigned int frame) {
+                terminal.drawOn(panes[pane].get()).setBackground(Color(1 + pane % 6)).clear();
+                for (unsigned int row = 0; row < rows; row++) terminal.placeCursor(0, row).printClipped(columns, "%u: %u pane %u", row, frame, pane);
+        };
+        for (unsigned int pane = 0; pane < 12; pane++) {
+                panes.emplace_back(new Canvas(terminal, int(pane % 4 * columns), int(pane / 4 * rows), columns, rows));
+                drawPane(pane, 0);
+        }
+        Canvas popup(terminal, 10, 10, 40, 12, 1);
+        terminal.drawOn(&popup).setBackground(Color::WHITE).clear();
+        for (unsigned int row = 0; row < popup.rows(); row++) terminal.placeCursor(0, row).print("The popup in front of the panes, row %u", row);
+        terminal.present().flush();
+
+        uint64_t bytesBefore = io.bytesWritten();
+        uint64_t startTime = Terminal::monotonicNanos();
+        for (unsigned int frame = 0; frame < FRAMES; frame++) {
+                if (movePopup) {
+                        popup.moveTo(int(frame % 100), int(frame / 100 % 30));
+                } else {
+                        drawPane(frame % 12, frame);
+                }
+                terminal.present().flush();
+        }
+        report("canvas", name, FRAMES, startTime, io.bytesWritten() - bytesBefore);
+}
+
+int main(int argc, char** argv) {
+        groupCount = argc - 1;
+        groups = argv + 1;
+        if (enabled("csi")) benchCsi();
+        if (enabled("parse")) benchParsers();
+        if (enabled("encode")) benchEncoders();
+        if (enabled("frame")) benchFrameScenarios();
+        if (enabled("canvas")) {
+                benchCanvases("redraw_pane", false);
+                benchCanvases("move_popup", true);
+        }
+        return 0;
+}
@@ -0,0 +1,103 @@
+#include "capabilitycache.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+/** Keep tabs and line breaks out of what is written as a tab separated field of a line. */
+static std::string sanitized(char const* text) {
+        std::string result(text);
+        for (char& c : result) {
+                if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+        return result;
+}
+
+CapabilityCache::CapabilityCache() {
+        char const* cacheHome = getenv("XDG_CACHE_HOME");
+        if (cacheHome != nullptr && *cacheHome != '\0') {
+                mPath = cacheHome;
+        } else {
+                char const* home = getenv("HOME");
+                // Without a place for it, use a path that cannot be opened so that nothing is cached.
+                if (home == nullptr || *home == '\0') return;
+                mPath = std::string(home) + "/.cache";
+        }
+        mPath += "/screencanvas/capabilities";
+}
+
+std::string CapabilityCache::terminalKey(TerminalIo& io) {
+        std::string key;
+        for (char const* name : {"TERM", "COLORTERM", "TERM_PROGRAM", "TERM_PROGRAM_VERSION", "VTE_VERSION"}) {
+                char const* value = io.environment(name);
+                if (value == nullptr || *value == '\0') continue;
+                if (!key.empty()) key += ' ';
+                key += name;
+                key += '=';
+                key += sanitized(value);
+        }
+        return key;
+}
+
+bool CapabilityCache::load(std::string const& key, Entry& entry) const {
+        if (mPath.empty()) return false;
+        FILE* file = fopen(mPath.c_str(), "re");
+        if (file == nullptr) return false;
+        char* line = nullptr;
+        size_t capacity = 0;
+        bool found = false;
+        while (!found && getline(&line, &capacity, file) > 0) {
+                // A line is the key, the capabilities in hex and the version, separated by tabs.
+                char* capabilities = strchr(line, '\t');
+                if (capabilities == nullptr) continue;
+                *capabilities++ = '\0';
+                if (key != line) continue;
+                char* version = strchr(capabilities, '\t');
+                if (version == nullptr) continue;
+                *version++ = '\0';
+                version[strcspn(version, "\n")] = '\0';
+                entry.capabilities = uint32_t(strtoul(capabilities, nullptr, 16));
+                entry.version = version;
+                found = true;
+        }
+        free(line);
+        fclose(file);
+        return found;
+}
+
+void CapabilityCache::store(std::string const& key, Entry const& entry) const {
+        if (mPath.empty()) return;
+        // Keep the lines of other terminals.
+        std::vector<std::string> lines;
+        if (FILE* file = fopen(mPath.c_str(), "re")) {
+                char* line = nullptr;
+                size_t capacity = 0;
+                while (getline(&line, &capacity, file) > 0) {
+                        char const* tab = strchr(line, '\t');
+                        if (tab != nullptr && key.compare(0, std::string::npos, line, tab - line) != 0) lines.push_back(line);
+                }
+                free(line);
+                fclose(file);
+        }
+        char capabilities[16];
+        snprintf(capabilities, sizeof(capabilities), "%x", entry.capabilities);
+        lines.push_back(key + '\t' + capabilities + '\t' + sanitized(entry.version.c_str()) + '\n');
+
+        // Create the directories, of which only the last two may be missing.
+        size_t slash = mPath.rfind('/');
+        if (slash != std::string::npos) {
+                std::string directory = mPath.substr(0, slash);
+                size_t parentSlash = directory.rfind('/');
+                if (parentSlash != std::string::npos && parentSlash > 0) mkdir(directory.substr(0, parentSlash).c_str(), 0700);
+                mkdir(directory.c_str(), 0700);
+        }
+        std::string temporary = mPath + "." + std::to_string(getpid());
+        FILE* file = fopen(temporary.c_str(), "we");
+        if (file == nullptr) return;
+        for (std::string const& line : lines) fputs(line.c_str(), file);
+        if (fclose(file) != 0 || rename(temporary.c_str(), mPath.c_str()) != 0) unlink(temporary.c_str());
+}
@@ -0,0 +1,40 @@
+#ifndef CAPABILITYCACHE_HPP_INCLUDED
+#define CAPABILITYCACHE_HPP_INCLUDED
+
+#include "terminalio.hpp"
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+
+/** What Terminal::probeCapabilities() found out about terminals, kept in a file so that later startups in the same
+ * terminal need not ask it again. Terminals are told apart by the environment variables that name them and their
+ * version, which are known without asking. Failing to read or write the file only means that the terminal is asked. */
+class CapabilityCache {
+        public:
+                struct Entry {
+                        /** Bit mask of (1 << Capability). */
+                        uint32_t capabilities;
+                        /** The reply to XTVERSION, such as "xterm(388)", or empty if there was none. */
+                        std::string version;
+                };
+
+                /** The cache in $XDG_CACHE_HOME/screencanvas/capabilities, or in ~/.cache if XDG_CACHE_HOME is not set. */
+                CapabilityCache();
+                explicit CapabilityCache(std::string path) : mPath(std::move(path)) {}
+
+                /** The key of the terminal of io, from its TERM, COLORTERM, TERM_PROGRAM, TERM_PROGRAM_VERSION and
+                 * VTE_VERSION, or empty if it tells none of them. Over SSH only TERM is usually passed on, so terminals
+                 * with the same TERM share an entry. */
+                static std::string terminalKey(TerminalIo& io);
+
+                bool load(std::string const& key, Entry& entry) const;
+                /** Add or replace the entry of the key. The file is replaced as a whole, so readers never see half of it. */
+                void store(std::string const& key, Entry const& entry) const;
+                std::string const& path() const { return mPath; }
+        private:
+                std::string mPath;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef CONCURRENTQUEUES_HPP_INCLUDED
+#define CONCURRENTQUEUES_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/** A bounded lock-free queue that any number of threads may push to and a single thread pops from. Each slot has a
+ * sequence number that tells whose turn it is, so that a producer claims a slot with a single compare-and-swap and
+ * publishes it with a single store, and a full queue is reported instead of waited for. The capacity is a power of two. */
+template <typename T>
+class MpscRing {
+        public:
+                explicit MpscRing(size_t capacity) : mSlots(roundUpToPowerOfTwo(capacity)), mMask(mSlots.size() - 1) {
+                        for (size_t i = 0; i < mSlots.size(); i++) mSlots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+
+                /** Add a copy of value, returning false without waiting if the queue is full. */
+                bool push(T const& value) {
+                        size_t position = mTail.load(std::memory_order_relaxed);
+                        while (true) {
+                                Slot& slot = mSlots[position & mMask];
+                                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                                intptr_t difference = intptr_t(sequence) - intptr_t(position);
+                                if (difference == 0) {
+                                        if (mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                                                slot.value = value;
+                                                slot.sequence.store(position + 1, std::memory_order_release);
+                                                return true;
+                                        }
+                                } else if (difference < 0) {
+                                        return false;
+                                } else {
+                                        position = mTail.load(std::memory_order_relaxed);
+                                }
+                        }
+                }
+
+                /** Take the oldest value, returning false if there is none. Only one thread may pop. */
+                bool pop(T& value) {
+                        Slot& slot = mSlots[mHead & mMask];
+                        if (slot.sequence.load(std::memory_order_acquire) != mHead + 1) return false;
+                        value = slot.value;
+                        slot.sequence.store(mHead + mSlots.size(), std::memory_order_release);
+                        mHead++;
+                        return true;
+                }
+
+                /** If a value is ready to be popped. Only for the thread that pops. */
+                bool ready() const { return mSlots[mHead & mMask].sequence.load(std::memory_order_acquire) == mHead + 1; }
+        private:
+                struct Slot {
+                        std::atomic<size_t> sequence;
+                        T value;
+                };
+                std::vector<Slot> mSlots;
+                size_t const mMask;
+                /** Kept on separate cache lines, as they are written by different threads. */
+                alignas(64) std::atomic<size_t> mTail{0};
+                alignas(64) size_t mHead{0};
+
+                static size_t roundUpToPowerOfTwo(size_t value) {
+                        size_t power = 2;
+                        while (power < value) power *= 2;
+                        return power;
+                }
+};
+
+/** A bounded lock-free queue from one thread to another. The capacity is a power of two. */
+template <typename T>
+class SpscQueue {
+        public:
+                explicit SpscQueue(size_t capacity) : mSlots(roundUpToPowerOfTwo(capacity)), mMask(mSlots.size() - 1) {}
+
+                /** Add a copy of value, returning false if the queue is full. */
+                bool push(T const& value) {
+                        size_t tail = mTail.load(std::memory_order_relaxed);
+                        if (tail - mHead.load(std::memory_order_acquire) == mSlots.size()) return false;
+                        mSlots[tail & mMask] = value;
+                        mTail.store(tail + 1, std::memory_order_release);
+                        return true;
+                }
+
+                /** Take the oldest value, returning false if there is none. */
+                bool pop(T& value) {
+                        size_t head = mHead.load(std::memory_order_relaxed);
+                        if (head == mTail.load(std::memory_order_acquire)) return false;
+                        value = mSlots[head & mMask];
+                        mHead.store(head + 1, std::memory_order_release);
+                        return true;
+                }
+
+                bool empty() const { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire); }
+                bool full() const { return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire) == mSlots.size(); }
+        private:
+                std::vector<T> mSlots;
+                size_t const mMask;
+                alignas(64) std::atomic<size_t> mTail{0};
+                alignas(64) std::atomic<size_t> mHead{0};
+
+                static size_t roundUpToPowerOfTwo(size_t value) {
+                        size_t power = 2;
+                        while (power < value) power *= 2;
+                        return power;
+                }
+};
+
+/** Lets a thread sleep until another one has something for it. Notifying only takes the lock when the thread is
+ * asleep, so that the lock-free queues stay lock-free while the consumer keeps up. */
+class WakeUp {
+        public:
+                /** Wake the waiting thread, after making what it waits for visible. */
+                void notify() {
+                        // Pairs with the fence in wait(), so that either this sees the sleep or wait() sees what was made ready.
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (!mSleeping.load(std::memory_order_relaxed)) return;
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        mNotified = true;
+                        mCondition.notify_one();
+                }
+
+                /** Sleep until notified or the deadline in Terminal::monotonicNanos() time has passed, unless ready() is
+                 * true, which is checked after announcing the sleep so that a notification in between is not lost. */
+                template <typename Ready>
+                void wait(uint64_t deadline, uint64_t now, Ready const& ready) {
+                        std::unique_lock<std::mutex> lock(mMutex);
+                        mSleeping.store(true, std::memory_order_relaxed);
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (!ready()) {
+                                if (deadline == UINT64_MAX) {
+                                        mCondition.wait(lock, [this] { return mNotified; });
+                                } else if (deadline > now) {
+                                        mCondition.wait_for(lock, std::chrono::nanoseconds(deadline - now), [this] { return mNotified; });
+                                }
+                        }
+                        mNotified = false;
+                        mSleeping.store(false, std::memory_order_relaxed);
+                }
+        private:
+                std::mutex mMutex;
+                std::condition_variable mCondition;
+                bool mNotified{false};
+                std::atomic<bool> mSleeping{false};
+};
+
+#endif
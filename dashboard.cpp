@@ -0,0 +1,54 @@
+#include "reactor.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// Serves a dashboard to every client of a Unix socket, such as
+//   socat -,raw,echo=0 UNIX-CONNECT:/tmp/dashboard.sock
+// Sockets do not tell the size of the terminal, so all sessions are 24x80, but each terminal is probed for what it
+// supports. Press q in a session to close it.
+
+int main(int argc, char** argv) {
+        char const* path = (argc > 1) ? argv[1] : "/tmp/dashboard.sock";
+        int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+        unlink(path);
+        if (listenFd < 0 || bind(listenFd, (struct sockaddr*) &address, sizeof(address)) < 0 || listen(listenFd, 64) < 0) {
+                perror(path);
+                exit(1);
+        }
+        printf("Serving on %s\n", path);
+
+        Reactor reactor(2, [&reactor](uint64_t session, Event const& event) {
+                if (event.type == EventType::CHAR && event.character == 'q') reactor.closeSession(session);
+        });
+        uint64_t startTime = Terminal::monotonicNanos();
+        while (true) {
+                struct pollfd pollFd = { listenFd, POLLIN, 0 };
+                if (poll(&pollFd, 1, 100) > 0) {
+                        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                        if (fd >= 0) reactor.addSession(fd, fd, -1, Reactor::Environment(), true);
+                }
+                ReactorStats stats = reactor.stats();
+                size_t sessions = reactor.sessionCount();
+                unsigned long long seconds = (Terminal::monotonicNanos() - startTime) / 1000000000;
+                reactor.renderFrame([&](Terminal& t) {
+                        t.placeCursor(2, t.rows() - 2).setAttribute(Attribute::BOLD, true).print("Dashboard");
+                        t.resetColorsAndStyle().placeCursor(2, t.rows() - 4).print("Up for %llu:%02llu", seconds / 60, seconds % 60);
+                        t.placeCursor(2, t.rows() - 5).print("Sessions: %zu", sessions);
+                        t.placeCursor(2, t.rows() - 6).print("Frames encoded: %llu, repaints: %llu", (unsigned long long) stats.framesEncoded,
+                                        (unsigned long long) stats.keyframesEncoded);
+                        t.placeCursor(2, t.rows() - 7).print("Frames sent: %llu, skipped: %llu", (unsigned long long) stats.framesSent,
+                                        (unsigned long long) stats.framesSkipped);
+                        t.placeCursor(2, t.rows() - 8).print("Bytes written: %llu", (unsigned long long) stats.bytesWritten);
+                        t.setForeground(Color::GREEN).fillRectangle(2, 10, 3 + seconds % 40, 9, '#');
+                        t.resetColorsAndStyle().placeCursor(2, 1).print("Press q to quit");
+                });
+        }
+        return 0;
+}
@@ -0,0 +1,162 @@
+#ifndef ENCODER_HPP_INCLUDED
+#define ENCODER_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Maximum number of decimal digits in a uint32_t. */
+static constexpr size_t MAX_DECIMAL_LENGTH = 10;
+
+/** The number of decimal digits in value. */
+inline constexpr size_t decimalLength(uint32_t value) {
+        return (value < 10) ? 1 : (value < 100) ? 2 : (value < 1000) ? 3 : (value < 10000) ? 4 : (value < 100000) ? 5
+                : (value < 1000000) ? 6 : (value < 10000000) ? 7 : (value < 100000000) ? 8 : (value < 1000000000) ? 9 : 10;
+}
+
+/** Write value in decimal to out without any terminating null, returning the end of what was written. */
+inline char* writeDecimal(char* out, uint32_t value) {
+        static constexpr char DIGIT_PAIRS[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+        if (value < 10) {
+                *out = char('0' + value);
+                return out + 1;
+        }
+        char* end = out + decimalLength(value);
+        char* position = end;
+        while (value >= 100) {
+                unsigned int pair = (value % 100) * 2;
+                value /= 100;
+                position -= 2;
+                position[0] = DIGIT_PAIRS[pair];
+                position[1] = DIGIT_PAIRS[pair + 1];
+        }
+        if (value >= 10) {
+                position -= 2;
+                position[0] = DIGIT_PAIRS[value * 2];
+                position[1] = DIGIT_PAIRS[value * 2 + 1];
+        } else {
+                *--position = char('0' + value);
+        }
+        return end;
+}
+
+/** The number of bytes of codepoint encoded as UTF-8. */
+inline constexpr size_t utf8Length(uint32_t codepoint) {
+        return (codepoint < 0x80) ? 1 : (codepoint < 0x800) ? 2 : (codepoint < 0x10000) ? 3 : 4;
+}
+
+/** Write codepoint as UTF-8 to out, returning the end of what was written. */
+inline char* writeUtf8(char* out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+                *out++ = char(codepoint);
+        } else if (codepoint < 0x800) {
+                *out++ = char(0xC0 | (codepoint >> 6));
+                *out++ = char(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+                *out++ = char(0xE0 | (codepoint >> 12));
+                *out++ = char(0x80 | ((codepoint >> 6) & 0x3F));
+                *out++ = char(0x80 | (codepoint & 0x3F));
+        } else {
+                *out++ = char(0xF0 | (codepoint >> 18));
+                *out++ = char(0x80 | ((codepoint >> 12) & 0x3F));
+                *out++ = char(0x80 | ((codepoint >> 6) & 0x3F));
+                *out++ = char(0x80 | (codepoint & 0x3F));
+        }
+        return out;
+}
+
+/** The shape of a control sequence: CSI, an optional private marker, numeric parameters separated
+ * by ';', an optional intermediate byte and a final byte. A zero Private or Intermediate means none.
+ * All of it except the parameter values is known at compile time, so encoding is just a few stores. */
+template <char Private, char Intermediate, char Final>
+struct ControlSequence {
+        /** Upper bound of the encoded length with the given number of parameters. */
+        static constexpr size_t maxLength(size_t parameters) {
+                return 2 + (Private ? 1 : 0) + parameters * (MAX_DECIMAL_LENGTH + 1) + (Intermediate ? 1 : 0) + 1;
+        }
+
+        /** The exact encoded length with the given parameters, for comparing the cost of alternatives. */
+        template <typename... Params>
+        static constexpr size_t length(Params... params) {
+                return 2 + (Private ? 1 : 0) + parametersLength(params...) + (Intermediate ? 1 : 0) + 1;
+        }
+
+        template <typename... Params>
+        static char* write(char* out, Params... params) {
+                *out++ = '\033';
+                *out++ = '[';
+                if (Private) *out++ = Private;
+                out = writeParameters(out, params...);
+                if (Intermediate) *out++ = Intermediate;
+                *out++ = Final;
+                return out;
+        }
+
+        /** Like write(), for a number of parameters that is only known at runtime. */
+        static char* writeArray(char* out, uint32_t const* params, size_t count) {
+                *out++ = '\033';
+                *out++ = '[';
+                if (Private) *out++ = Private;
+                for (size_t i = 0; i < count; i++) {
+                        if (i > 0) *out++ = ';';
+                        out = writeDecimal(out, params[i]);
+                }
+                if (Intermediate) *out++ = Intermediate;
+                *out++ = Final;
+                return out;
+        }
+
+        private:
+                static constexpr size_t parametersLength() { return 0; }
+
+                template <typename... Rest>
+                static constexpr size_t parametersLength(uint32_t first, Rest... rest) {
+                        return decimalLength(first) + (sizeof...(Rest) > 0 ? 1 : 0) + parametersLength(rest...);
+                }
+
+                static char* writeParameters(char* out) { return out; }
+
+                template <typename... Rest>
+                static char* writeParameters(char* out, uint32_t first, Rest... rest) {
+                        out = writeDecimal(out, first);
+                        if (sizeof...(Rest) > 0) *out++ = ';';
+                        return writeParameters(out, rest...);
+                }
+};
+
+/** The control sequences used by Terminal, named as in the xterm documentation. */
+namespace Csi {
+        using CUU = ControlSequence<0, 0, 'A'>;         // Cursor Up
+        using CUD = ControlSequence<0, 0, 'B'>;         // Cursor Down
+        using CUF = ControlSequence<0, 0, 'C'>;         // Cursor Forward
+        using CUB = ControlSequence<0, 0, 'D'>;         // Cursor Backward
+        using CHA = ControlSequence<0, 0, 'G'>;         // Cursor Character Absolute
+        using CUP = ControlSequence<0, 0, 'H'>;         // Cursor Position
+        using ED = ControlSequence<0, 0, 'J'>;          // Erase in Display
+        using EL = ControlSequence<0, 0, 'K'>;          // Erase in Line
+        using IL = ControlSequence<0, 0, 'L'>;          // Insert Lines
+        using DL = ControlSequence<0, 0, 'M'>;          // Delete Lines
+        using DCH = ControlSequence<0, 0, 'P'>;         // Delete Characters
+        using SU = ControlSequence<0, 0, 'S'>;          // Scroll Up
+        using SD = ControlSequence<0, 0, 'T'>;          // Scroll Down
+        using ECH = ControlSequence<0, 0, 'X'>;         // Erase Characters
+        using REP = ControlSequence<0, 0, 'b'>;         // Repeat the preceding graphic character
+        using DA1 = ControlSequence<0, 0, 'c'>;         // Primary Device Attributes
+        using SGR = ControlSequence<0, 0, 'm'>;         // Select Graphic Rendition
+        using DSR = ControlSequence<0, 0, 'n'>;         // Device Status Report
+        using DECSTBM = ControlSequence<0, 0, 'r'>;     // Set Top and Bottom Margins
+        using DECSET = ControlSequence<'?', 0, 'h'>;    // DEC Private Mode Set
+        using DECRST = ControlSequence<'?', 0, 'l'>;    // DEC Private Mode Reset
+        using DECRQM = ControlSequence<'?', '$', 'p'>;  // Request DEC Private Mode
+        using DA2 = ControlSequence<'>', 0, 'c'>;       // Secondary Device Attributes
+        using XTVERSION = ControlSequence<'>', 0, 'q'>; // Report xterm name and version
+        using DECSCUSR = ControlSequence<0, ' ', 'q'>;  // Set Cursor Style
+        using DECCRA = ControlSequence<0, '$', 'v'>;    // Copy Rectangular Area
+        using DECFRA = ControlSequence<0, '$', 'x'>;    // Fill Rectangular Area
+        using DECERA = ControlSequence<0, '$', 'z'>;    // Erase Rectangular Area
+}
+
+#endif
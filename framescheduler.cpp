@@ -0,0 +1,47 @@
+#include "framescheduler.hpp"
+
+FrameScheduler::FrameScheduler(Terminal& terminal, unsigned int maxFramesPerSecond, std::function<void(Terminal&)> render)
+        : mTerminal(terminal), mRender(render), mFrameInterval(1000000000ull / (maxFramesPerSecond == 0 ? 1 : maxFramesPerSecond)) {
+        mTerminal.setRetainedMode(true).setAutoPresent(false).setSynchronizedUpdates(true);
+        requestFrame();
+}
+
+FrameScheduler::~FrameScheduler() {
+        mTerminal.setAutoPresent(true).setSynchronizedUpdates(false);
+}
+
+EventType FrameScheduler::await(int timeoutMilliseconds) {
+        uint64_t deadline = timeoutMilliseconds < 0 ? UINT64_MAX : Terminal::monotonicNanos() + uint64_t(timeoutMilliseconds) * 1000000;
+        while (true) {
+                uint64_t now = Terminal::monotonicNanos();
+                if (mDirty && now >= mNextFrameTime) {
+                        renderFrame(now);
+                        continue;
+                }
+                uint64_t wakeUp = (mDirty && mNextFrameTime < deadline) ? mNextFrameTime : deadline;
+                EventType type = mTerminal.awaitUntil(wakeUp);
+                if (type == EventType::RESIZE) mDirty = true;
+                if (type != EventType::TIMEOUT) return type;
+                if (Terminal::monotonicNanos() >= deadline) return EventType::TIMEOUT;
+        }
+}
+
+void FrameScheduler::renderFrame(uint64_t now) {
+        uint64_t dueTime = (mRequestTime > mNextFrameTime) ? mRequestTime : mNextFrameTime;
+        if (now >= dueTime + mFrameInterval) {
+                // Input handling or rendering kept the frame from being presented in its own interval.
+                mStats.late++;
+                mStats.dropped += (now - dueTime) / mFrameInterval;
+        }
+        mDirty = false;
+
+        mTerminal.beginFrame();
+        mRender(mTerminal);
+        mTerminal.present();
+        mTerminal.endFrame();
+
+        uint64_t renderedTime = Terminal::monotonicNanos();
+        mStats.renderNanos += renderedTime - now;
+        if (mTerminal.lastPresentChanged()) mStats.presented++; else mStats.skipped++;
+        mNextFrameTime = now + mFrameInterval;
+}
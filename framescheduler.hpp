@@ -0,0 +1,55 @@
+#ifndef FRAMESCHEDULER_HPP_INCLUDED
+#define FRAMESCHEDULER_HPP_INCLUDED
+
+#include "screencanvas.hpp"
+
+#include <functional>
+
+/** Counters of what a FrameScheduler has done. */
+struct FrameStats {
+        /** Frames that were rendered and had changes to present. */
+        uint64_t presented{0};
+        /** Frames that were rendered but turned out to have nothing to present. */
+        uint64_t skipped{0};
+        /** Frames that were presented more than one frame interval after they were due. */
+        uint64_t late{0};
+        /** Frame intervals that passed without a frame while one was due. */
+        uint64_t dropped{0};
+        /** Time spent in the render function and present(), in nanoseconds. */
+        uint64_t renderNanos{0};
+};
+
+/** Paces the rendering of a Terminal in retained mode to at most a given number of frames per second.
+ * Calling requestFrame() marks the screen as dirty, and while waiting for input with await() the render
+ * function is called followed by present() at most once per frame interval, and only if dirty. Input is
+ * returned as soon as it arrives, so rendering is throttled without adding input latency. */
+class FrameScheduler {
+        public:
+                FrameScheduler(Terminal& terminal, unsigned int maxFramesPerSecond, std::function<void(Terminal&)> render);
+                ~FrameScheduler();
+
+                /** Schedule a frame. Requests are merged until the frame is rendered. */
+                void requestFrame() { if (!mDirty) { mDirty = true; mRequestTime = Terminal::monotonicNanos(); } }
+                bool framePending() const { return mDirty; }
+
+                /** Like Terminal::await(), but renders due frames while waiting. A RESIZE requests a frame. */
+                EventType await(int timeoutMilliseconds = -1);
+
+                FrameStats const& stats() const { return mStats; }
+                uint64_t frameIntervalNanos() const { return mFrameInterval; }
+
+        private:
+                Terminal& mTerminal;
+                std::function<void(Terminal&)> mRender;
+                uint64_t mFrameInterval;
+                /** The earliest time the next frame may be presented. */
+                uint64_t mNextFrameTime{0};
+                bool mDirty{false};
+                /** When the pending frame was first requested. */
+                uint64_t mRequestTime{0};
+                FrameStats mStats;
+
+                void renderFrame(uint64_t now);
+};
+
+#endif
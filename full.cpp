@@ -2,7 +2,7 @@
 
 int main() {
         Terminal term;
-        term.enterAltScreen().enableMouse().placeCursor(50, 50);
+        term.enterAltScreen().enableMouse().setFocusReporting(true).probeCapabilities().placeCursor(50, 50);
         term.setWrapAround(true);
         term
                 //.setForeground(Color::BLACK)
@@ -34,6 +34,9 @@ int main() {
                                         case Key::F10: term.setForeground(Color::YELLOW).print("F10"); break;
                                         case Key::F11: term.setForeground(Color::BLUE).print("F11"); break;
                                         case Key::F12: term.setForeground(Color::MAGENTA).print("F12"); break;
+                                        case Key::HOME: term.placeCursorAtColumn(0); break;
+                                        case Key::END: term.placeCursorAtColumn(term.columns() - 1); break;
+                                        case Key::DELETE: term.deleteCells(1); break;
                                         default: break;
                                 }
                                 break;
@@ -76,12 +79,22 @@ int main() {
                                        else term.print("%c",(char) c);
                                }
                                break;
+                       case EventType::FOCUS_IN:
+                       case EventType::FOCUS_OUT:
+                               term.setTitle(term.lastEvent().type == EventType::FOCUS_IN ? "FOCUSED" : "NOT FOCUSED");
+                               break;
+                       case EventType::CAPABILITIES:
+                               term.setTitle("%s", term.terminalVersion().empty() ? "UNKNOWN TERMINAL" : term.terminalVersion().c_str());
+                               break;
                        case EventType::RESIZE:
                                term.setTitle("RESIZE %d,%d", term.columns(), term.rows()).clear().placeCursor(term.columns()/2, 0);
                                break;
                        case EventType::TIMEOUT:
                                term.print("TIMEOUT ");
                                break;
+                       case EventType::INPUT_ENDED:
+                               run = false;
+                               break;
                        case EventType::MOUSE_DOWN:
                        case EventType::MOUSE_UP:
                                term.placeCursor(term.lastMouseColumn(), term.lastMouseRow());
@@ -0,0 +1,77 @@
+#include "screencanvas.hpp"
+
+#include <memory>
+
+// A dashboard of twelve panes that each count at their own pace, with a popup in front of them that the arrow keys
+// move and space hides. Each frame only composites the panes that changed and where the popup was and is.
+
+static const unsigned int GRID_COLUMNS = 4;
+static const unsigned int GRID_ROWS = 3;
+
+struct Pane {
+        std::unique_ptr<Canvas> canvas;
+        unsigned int period;
+        unsigned long long count;
+};
+
+static void drawPane(Terminal& term, Pane& pane, unsigned int index) {
+        term.drawOn(pane.canvas.get()).setBackground(Color(index % 6 + 1)).setForeground(Color::BLACK).clear();
+        unsigned int top = term.rows() > 0 ? term.rows() - 1 : 0;
+        term.placeCursor(1, top).printClipped(term.columns() - 1, "Pane %u, every %u ticks", index + 1, pane.period);
+        term.placeCursor(1, top / 2).printClipped(term.columns() - 1, "%llu", pane.count);
+        term.drawOn(nullptr);
+}
+
+static void layout(Terminal& term, std::vector<Pane>& panes) {
+        unsigned int columns = term.columns() / GRID_COLUMNS, rows = (term.rows() - 1) / GRID_ROWS;
+        for (unsigned int i = 0; i < panes.size(); i++) {
+                // Row 0 is the bottom, so the first pane goes in the top left corner, above the help line.
+                Canvas& canvas = *panes[i].canvas;
+                canvas.resize(columns, rows).moveTo(int(i % GRID_COLUMNS * columns), int(1 + (GRID_ROWS - 1 - i / GRID_COLUMNS) * rows));
+                drawPane(term, panes[i], i);
+        }
+        term.resetColorsAndStyle().clear().placeCursor(0, 0).print("Arrows move the popup, space hides it, q quits");
+}
+
+int main() {
+        Terminal term;
+        // The probe is answered while the panes are drawn, and decides if moving the popup can use DECCRA.
+        term.enterAltScreen().setRetainedMode(true).hideCursor().probeCapabilities();
+        std::vector<Pane> panes;
+        for (unsigned int i = 0; i < GRID_COLUMNS * GRID_ROWS; i++) panes.push_back(Pane{std::unique_ptr<Canvas>(new Canvas(term, 0, 0, 1, 1)), 1 + i * 3, 0});
+        Canvas popup(term, 4, 4, 30, 5, 1);
+        term.drawOn(&popup).setBackground(Color::WHITE).setForeground(Color::BLUE).clear();
+        term.placeCursor(2, 3).print("A popup in front of panes");
+        term.placeCursor(2, 1).print("Move it with the arrow keys");
+        term.drawOn(nullptr);
+        layout(term, panes);
+
+        for (unsigned int tick = 0;; tick++) {
+                EventType event = term.await(20);
+                if (event == EventType::TIMEOUT) {
+                        for (unsigned int i = 0; i < panes.size(); i++) {
+                                if (tick % panes[i].period != 0) continue;
+                                panes[i].count++;
+                                drawPane(term, panes[i], i);
+                        }
+                } else if (event == EventType::RESIZE) {
+                        layout(term, panes);
+                } else if (event == EventType::KEY) {
+                        int column = popup.column(), row = popup.row();
+                        switch (term.lastKey()) {
+                                case Key::UP: row++; break;
+                                case Key::DOWN: row--; break;
+                                case Key::LEFT: column -= 2; break;
+                                case Key::RIGHT: column += 2; break;
+                                default: break;
+                        }
+                        popup.moveTo(column, row);
+                } else if (event == EventType::CHAR) {
+                        if (term.lastCharacter() == ' ') popup.setVisible(!popup.visible());
+                        if (term.lastCharacter() == 'q') break;
+                } else if (event == EventType::INPUT_ENDED) {
+                        break;
+                }
+        }
+        return 0;
+}
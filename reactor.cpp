@@ -0,0 +1,580 @@
+#include "reactor.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+/** A session is skipped by renderFrame() while it has more than this queued. */
+static const size_t MAX_QUEUED_BYTES = 256 * 1024;
+/** How much a worker reads from one session before serving the others. */
+static const size_t MAX_READ_BYTES = 64 * 1024;
+static const int MAX_EPOLL_EVENTS = 64;
+static const int MAX_WRITE_CHUNKS = 16;
+
+using Frame = std::shared_ptr<std::vector<char> const>;
+
+/** Input that the worker has read, which is parsed by the Terminal of the session, and output that goes to the queue
+ * of the session. The size is that of the terminal if the input is one, unless set with setSize(). The environment is
+ * what the client told, never that of this process. */
+class SessionIo : public FdIo {
+        public:
+                SessionIo(std::function<void(char const*, size_t)> queue, int inputFd, int outputFd, Reactor::Environment const& environment)
+                        : FdIo(inputFd, outputFd, -1, false), mQueue(queue), mEnvironment(environment) {}
+
+                unsigned int wait(uint64_t deadline) override {
+                        unsigned int ready = mBuffered.wait(deadline);
+                        if (mResizeSignalled) ready |= RESIZE;
+                        mResizeSignalled = false;
+                        return ready;
+                }
+                ssize_t read(uint8_t* buffer, size_t capacity) override { return mBuffered.read(buffer, capacity); }
+                unsigned int write(char const* data, size_t length, size_t& written) override { mQueue(data, length); written = length; return 0; }
+                bool size(Size& size) override { return mSizeSet ? mBuffered.size(size) : FdIo::size(size); }
+                char const* environment(char const* name) override {
+                        auto found = mEnvironment.find(name);
+                        return found == mEnvironment.end() ? nullptr : found->second.c_str();
+                }
+
+                void feed(void const* data, size_t length) { mBuffered.feed(data, length); }
+                void setSize(Size size) { mSizeSet = true; mBuffered.setSize(size); }
+                /** Ask for the size again on the next wait(). */
+                void signalResize() { mResizeSignalled = true; }
+        private:
+                std::function<void(char const*, size_t)> mQueue;
+                Reactor::Environment mEnvironment;
+                MemoryIo mBuffered;
+                bool mSizeSet{false};
+                bool mResizeSignalled{false};
+};
+
+struct Reactor::Worker {
+        unsigned int index;
+        int epollFd;
+        /** An eventfd that wakes the worker when there is mail. */
+        int wakeFd;
+        std::thread thread;
+        std::mutex mutex;
+        /** Sessions that have been queued output or requests since the worker last looked. */
+        std::vector<Session*> mailbox;
+        /** Sessions whose Terminal::nextDeadline() is not UINT64_MAX, with that deadline. Only used by the worker. */
+        std::map<Session*, uint64_t> timers;
+};
+
+struct Reactor::Session {
+        struct Chunk { Frame data; size_t offset; };
+
+        uint64_t id;
+        Worker& worker;
+        int inputFd, outputFd, resizeFd;
+
+        /** Guards the output queue and the requests. */
+        std::mutex mutex;
+        std::deque<Chunk> output;
+        size_t queuedBytes{0};
+        bool closeRequested{false};
+        bool sizeRequested{false};
+        Size requestedSize{0, 0};
+        /** If the input should be parsed although none has arrived, as when a probe has been started. */
+        bool parseRequested{false};
+        /** If EPOLLOUT is asked for. */
+        bool writeInterest{false};
+
+        SessionIo io;
+        /** Parses the input. It is never in retained mode, and its output, such as for entering the alternate screen, is queued. */
+        std::unique_ptr<Terminal> terminal;
+
+        /** Guarded by the mutex of the Reactor. */
+        SizeGroup* group{nullptr};
+        /** If the session was sent the last frame of its group, so that it can be sent the changes from it. */
+        bool inSync{false};
+
+        /** Only used by the worker. */
+        bool closed{false};
+
+        Session(uint64_t id, Worker& worker, int inputFd, int outputFd, int resizeFd, Environment const& environment)
+                : id(id), worker(worker), inputFd(inputFd), outputFd(outputFd), resizeFd(resizeFd),
+                  io([this](char const* data, size_t length) { queue(std::make_shared<std::vector<char>>(data, data + length)); }, inputFd, outputFd, environment),
+                  terminal(new Terminal(io)) {
+        }
+
+        /** Requires the mutex. */
+        void queueLocked(Frame const& frame) {
+                output.push_back(Chunk{frame, 0});
+                queuedBytes += frame->size();
+        }
+        void queue(Frame const& frame) {
+                std::lock_guard<std::mutex> lock(mutex);
+                queueLocked(frame);
+        }
+
+        void closeDescriptors() {
+                close(inputFd);
+                if (outputFd != inputFd) close(outputFd);
+                if (resizeFd != -1) close(resizeFd);
+        }
+};
+
+/** Sessions of the same size and capabilities, which all show the same frame from the same pair of Terminals. */
+struct Reactor::SizeGroup {
+        Size size;
+        uint32_t capabilities;
+        /** Only used by renderFrame(), without the mutex of the Reactor. */
+        MemoryIo deltaIo, keyframeIo;
+        /** Presents the changes from the previous frame, and a complete repaint for sessions that missed it. */
+        Terminal delta, keyframe;
+        /** Guarded by the mutex of the Reactor. */
+        std::vector<Session*> sessions;
+        /** If a keyframe was sent with the last frame, which may have left the cursor and style elsewhere than delta thinks. */
+        bool keyframeSent{false};
+
+        SizeGroup(Size size, uint32_t capabilities)
+                : size(size), capabilities(capabilities), deltaIo(size), keyframeIo(size), delta(deltaIo), keyframe(keyframeIo) {
+                for (Terminal* terminal : {&delta, &keyframe}) {
+                        terminal->setCapabilities(capabilities).setRetainedMode(true).setSynchronizedUpdates(true).hideCursor();
+                }
+                deltaIo.clearOutput();
+                keyframeIo.clearOutput();
+        }
+};
+
+static std::pair<uint64_t, uint32_t> groupKey(Size size, uint32_t capabilities) {
+        return std::make_pair((uint64_t(size.rows) << 32) | size.columns, capabilities);
+}
+
+/** Milliseconds until the deadline for epoll_wait(), rounded up so that the deadline has passed when epoll_wait() times out. */
+static int epollTimeout(uint64_t deadline) {
+        if (deadline == UINT64_MAX) return -1;
+        uint64_t now = Terminal::monotonicNanos();
+        return (now >= deadline) ? 0 : int((deadline - now + 999999) / 1000000);
+}
+
+static void makeNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+static void epollControl(int epollFd, int operation, int fd, uint32_t events, void* data) {
+        struct epoll_event event = {};
+        event.events = events;
+        event.data.ptr = data;
+        if (epoll_ctl(epollFd, operation, fd, &event) < 0 && operation != EPOLL_CTL_DEL) {
+                perror("epoll_ctl()");
+                exit(1);
+        }
+}
+
+/** Draw a frame on terminal and take what present() sends, or nullptr if nothing. */
+static Frame encodeFrame(Terminal& terminal, MemoryIo& io, std::function<void(Terminal&)> const& draw, bool repaint) {
+        terminal.resetColorsAndStyle().clear().placeCursor(0, terminal.rows() - 1);
+        draw(terminal);
+        if (repaint) terminal.repaint();
+        terminal.present().flush();
+        ByteSpan output = io.output();
+        Frame frame = (output.length == 0) ? nullptr : std::make_shared<std::vector<char>>((char const*) output.data, (char const*) output.data + output.length);
+        io.clearOutput();
+        return frame;
+}
+
+Reactor::Reactor(unsigned int threads, EventHandler onEvent, ClosedHandler onClosed) : mOnEvent(onEvent), mOnClosed(onClosed) {
+        signal(SIGPIPE, SIG_IGN);
+        for (unsigned int i = 0; i < std::max(threads, 1u); i++) {
+                std::unique_ptr<Worker> worker(new Worker());
+                worker->index = i;
+                worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+                worker->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (worker->epollFd < 0 || worker->wakeFd < 0) {
+                        perror("epoll_create1() or eventfd() failed");
+                        exit(1);
+                }
+                epollControl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeFd, EPOLLIN, nullptr);
+                mWorkers.push_back(std::move(worker));
+        }
+        for (auto& worker : mWorkers) {
+                Worker* w = worker.get();
+                w->thread = std::thread([this, w] { run(*w); });
+        }
+}
+
+Reactor::~Reactor() {
+        mStopping.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        for (auto& worker : mWorkers) {
+                if (::write(worker->wakeFd, &one, sizeof(one)) < 0) {}
+                worker->thread.join();
+        }
+        for (auto& entry : mSessions) {
+                Session& session = *entry.second;
+                session.terminal.reset();
+                writeOutput(session);
+                session.closeDescriptors();
+        }
+        for (auto& worker : mWorkers) {
+                close(worker->epollFd);
+                close(worker->wakeFd);
+        }
+}
+
+uint64_t Reactor::addSession(int inputFd, int outputFd, int resizeFd, Environment const& environment, bool probe) {
+        for (int fd : {inputFd, outputFd, resizeFd}) {
+                if (fd != -1) makeNonBlocking(fd);
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        uint64_t id = mNextSession++;
+        Worker& worker = *mWorkers[mNextWorker++ % mWorkers.size()];
+        std::unique_ptr<Session> owned(new Session(id, worker, inputFd, outputFd, resizeFd, environment));
+        Session* session = owned.get();
+        mSessions[id] = std::move(owned);
+        session->terminal->enterAltScreen().hideCursor().flush();
+        if (probe) {
+                // The worker parses the replies, or finds the result from the cache, and moves the session to its group.
+                session->terminal->probeCapabilities();
+                session->parseRequested = true;
+        }
+        regroup(*session);
+
+        epollControl(worker.epollFd, EPOLL_CTL_ADD, inputFd, EPOLLIN, session);
+        if (outputFd != inputFd) epollControl(worker.epollFd, EPOLL_CTL_ADD, outputFd, 0, session);
+        if (resizeFd != -1) epollControl(worker.epollFd, EPOLL_CTL_ADD, resizeFd, EPOLLIN, session);
+        mSessionsOpened.fetch_add(1, std::memory_order_relaxed);
+        wake(worker, session);
+        return id;
+}
+
+void Reactor::setSessionSize(uint64_t id, Size size) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto found = mSessions.find(id);
+        if (found == mSessions.end()) return;
+        Session& session = *found->second;
+        {
+                std::lock_guard<std::mutex> sessionLock(session.mutex);
+                session.sizeRequested = true;
+                session.requestedSize = size;
+        }
+        wake(session.worker, &session);
+}
+
+void Reactor::closeSession(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto found = mSessions.find(id);
+        if (found == mSessions.end()) return;
+        Session& session = *found->second;
+        {
+                std::lock_guard<std::mutex> sessionLock(session.mutex);
+                session.closeRequested = true;
+        }
+        wake(session.worker, &session);
+}
+
+size_t Reactor::sessionCount() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSessions.size();
+}
+
+ReactorStats Reactor::stats() const {
+        ReactorStats stats;
+        stats.sessionsOpened = mSessionsOpened.load(std::memory_order_relaxed);
+        stats.sessionsClosed = mSessionsClosed.load(std::memory_order_relaxed);
+        stats.framesEncoded = mFramesEncoded.load(std::memory_order_relaxed);
+        stats.keyframesEncoded = mKeyframesEncoded.load(std::memory_order_relaxed);
+        stats.framesSent = mFramesSent.load(std::memory_order_relaxed);
+        stats.framesSkipped = mFramesSkipped.load(std::memory_order_relaxed);
+        stats.bytesWritten = mBytesWritten.load(std::memory_order_relaxed);
+        return stats;
+}
+
+void Reactor::renderFrame(std::function<void(Terminal&)> const& draw) {
+        std::vector<bool> notify(mWorkers.size(), false);
+        std::vector<std::shared_ptr<SizeGroup>> groups;
+        {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (auto& entry : mGroups) groups.push_back(entry.second);
+        }
+        for (std::shared_ptr<SizeGroup> const& shared : groups) {
+                SizeGroup& group = *shared;
+                // Draw and encode without the lock, which workers take to move sessions between groups.
+                bool keyframeNeeded = false;
+                {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        if (group.sessions.empty()) continue;
+                        for (Session* session : group.sessions) {
+                                if (session->inSync) continue;
+                                // Sessions that will be skipped do not need the repaint yet.
+                                std::lock_guard<std::mutex> sessionLock(session->mutex);
+                                keyframeNeeded |= !session->closeRequested && session->queuedBytes <= MAX_QUEUED_BYTES;
+                        }
+                }
+                if (group.keyframeSent) group.delta.forgetCursorAndStyle();
+                group.keyframeSent = false;
+                Frame delta = encodeFrame(group.delta, group.deltaIo, draw, false);
+                mFramesEncoded.fetch_add(1, std::memory_order_relaxed);
+                Frame keyframe;
+                if (keyframeNeeded) {
+                        keyframe = encodeFrame(group.keyframe, group.keyframeIo, draw, true);
+                        mKeyframesEncoded.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                // Queue to the sessions that are in the group now, which may have changed while drawing.
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (Session* session : group.sessions) {
+                        Frame frame;
+                        {
+                                std::lock_guard<std::mutex> sessionLock(session->mutex);
+                                if (session->closeRequested) continue;
+                                if (session->queuedBytes > MAX_QUEUED_BYTES) {
+                                        session->inSync = false;
+                                        mFramesSkipped.fetch_add(1, std::memory_order_relaxed);
+                                        continue;
+                                }
+                                if (session->inSync) {
+                                        frame = delta;
+                                } else {
+                                        // A session that joined while drawing gets the keyframe of the next frame.
+                                        if (!keyframe) continue;
+                                        frame = keyframe;
+                                        session->inSync = true;
+                                        group.keyframeSent = true;
+                                }
+                                if (!frame) continue;
+                                session->queueLocked(frame);
+                        }
+                        mFramesSent.fetch_add(1, std::memory_order_relaxed);
+                        std::lock_guard<std::mutex> workerLock(session->worker.mutex);
+                        session->worker.mailbox.push_back(session);
+                        notify[session->worker.index] = true;
+                }
+        }
+        uint64_t one = 1;
+        for (auto& worker : mWorkers) {
+                if (notify[worker->index] && ::write(worker->wakeFd, &one, sizeof(one)) < 0) {}
+        }
+}
+
+void Reactor::wake(Worker& worker, Session* session) {
+        {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.mailbox.push_back(session);
+        }
+        uint64_t one = 1;
+        if (::write(worker.wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+void Reactor::regroup(Session& session) {
+        Size size = session.terminal->size();
+        uint32_t capabilities = session.terminal->capabilities();
+        if (session.group != nullptr) {
+                if (session.group->size.rows == size.rows && session.group->size.columns == size.columns
+                                && session.group->capabilities == capabilities) {
+                        return;
+                }
+                std::vector<Session*>& sessions = session.group->sessions;
+                sessions.erase(std::remove(sessions.begin(), sessions.end(), &session), sessions.end());
+                if (sessions.empty()) mGroups.erase(groupKey(session.group->size, session.group->capabilities));
+        }
+        std::shared_ptr<SizeGroup>& group = mGroups[groupKey(size, capabilities)];
+        if (!group) group.reset(new SizeGroup(size, capabilities));
+        group->sessions.push_back(&session);
+        session.group = group.get();
+        session.inSync = false;
+}
+
+void Reactor::run(Worker& worker) {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        std::vector<Session*> mail;
+        std::vector<Session*> closed;
+        auto closeLater = [&closed](Session* session) {
+                if (session->closed) return;
+                session->closed = true;
+                closed.push_back(session);
+        };
+
+        while (!mStopping.load(std::memory_order_acquire)) {
+                uint64_t deadline = UINT64_MAX;
+                for (auto const& timer : worker.timers) deadline = std::min(deadline, timer.second);
+                int count = epoll_wait(worker.epollFd, events, MAX_EPOLL_EVENTS, epollTimeout(deadline));
+                if (count < 0) {
+                        if (errno == EINTR) continue;
+                        perror("epoll_wait()");
+                        exit(1);
+                }
+                for (int i = 0; i < count; i++) {
+                        Session* session = (Session*) events[i].data.ptr;
+                        if (session == nullptr) {
+                                uint64_t value;
+                                if (::read(worker.wakeFd, &value, sizeof(value)) < 0) {}
+                                {
+                                        std::lock_guard<std::mutex> lock(worker.mutex);
+                                        mail.swap(worker.mailbox);
+                                }
+                                for (Session* mailed : mail) {
+                                        if (mailed->closed) continue;
+                                        bool closeRequested, sizeRequested, parseRequested;
+                                        Size size;
+                                        {
+                                                std::lock_guard<std::mutex> lock(mailed->mutex);
+                                                closeRequested = mailed->closeRequested;
+                                                sizeRequested = mailed->sizeRequested;
+                                                parseRequested = mailed->parseRequested;
+                                                size = mailed->requestedSize;
+                                                mailed->sizeRequested = false;
+                                                mailed->parseRequested = false;
+                                        }
+                                        if (closeRequested) {
+                                                closeLater(mailed);
+                                                continue;
+                                        }
+                                        if (sizeRequested) mailed->io.setSize(size);
+                                        if (sizeRequested || parseRequested) parseInput(*mailed);
+                                        if (!writeOutput(*mailed)) closeLater(mailed);
+                                }
+                                mail.clear();
+                                continue;
+                        }
+                        if (session->closed) continue;
+                        if (events[i].events & EPOLLERR) {
+                                closeLater(session);
+                                continue;
+                        }
+                        bool open = !(events[i].events & (EPOLLIN | EPOLLHUP)) || readInput(*session);
+                        if (!open || !writeOutput(*session)) closeLater(session);
+                }
+                if (!worker.timers.empty()) {
+                        // Parsing removes or moves the timer, so collect the sessions that are due first.
+                        uint64_t now = Terminal::monotonicNanos();
+                        for (auto const& timer : worker.timers) {
+                                if (timer.second <= now && !timer.first->closed) mail.push_back(timer.first);
+                        }
+                        for (Session* session : mail) {
+                                parseInput(*session);
+                                if (!writeOutput(*session)) closeLater(session);
+                        }
+                        mail.clear();
+                }
+                for (Session* session : closed) removeSession(worker, session);
+                closed.clear();
+        }
+}
+
+bool Reactor::readInput(Session& session) {
+        uint8_t buffer[4096];
+        size_t total = 0;
+        bool open = true;
+        while (total < MAX_READ_BYTES) {
+                ssize_t result = ::read(session.inputFd, buffer, sizeof(buffer));
+                if (result > 0) {
+                        session.io.feed(buffer, size_t(result));
+                        total += size_t(result);
+                } else if (result == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                        // The other end has gone away, which is also what reading a pseudo-terminal with EIO means.
+                        open = false;
+                        break;
+                } else if (errno != EINTR) {
+                        break;
+                }
+        }
+        if (session.resizeFd != -1) {
+                ssize_t result;
+                bool signalled = false;
+                while ((result = ::read(session.resizeFd, buffer, sizeof(buffer))) > 0) signalled = true;
+                if (signalled) session.io.signalResize();
+                if (result == 0) {
+                        epollControl(session.worker.epollFd, EPOLL_CTL_DEL, session.resizeFd, 0, nullptr);
+                        close(session.resizeFd);
+                        session.resizeFd = -1;
+                }
+        }
+        // Events that arrived before the end are still delivered.
+        parseInput(session);
+        return open;
+}
+
+void Reactor::parseInput(Session& session) {
+        while (session.terminal->awaitUntil(0) != EventType::TIMEOUT) {
+                Event const& event = session.terminal->lastEvent();
+                if (event.type == EventType::RESIZE || event.type == EventType::CAPABILITIES) {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        regroup(session);
+                }
+                mOnEvent(session.id, event);
+        }
+        uint64_t deadline = session.terminal->nextDeadline();
+        if (deadline == UINT64_MAX) {
+                session.worker.timers.erase(&session);
+        } else {
+                session.worker.timers[&session] = deadline;
+        }
+}
+
+bool Reactor::writeOutput(Session& session) {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        while (!session.output.empty()) {
+                struct iovec chunks[MAX_WRITE_CHUNKS];
+                int count = 0;
+                for (auto chunk = session.output.begin(); chunk != session.output.end() && count < MAX_WRITE_CHUNKS; ++chunk, ++count) {
+                        chunks[count].iov_base = (void*) (chunk->data->data() + chunk->offset);
+                        chunks[count].iov_len = chunk->data->size() - chunk->offset;
+                }
+                ssize_t written = writev(session.outputFd, chunks, count);
+                if (written < 0) {
+                        if (errno == EINTR) continue;
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                        return false;
+                }
+                mBytesWritten.fetch_add(uint64_t(written), std::memory_order_relaxed);
+                session.queuedBytes -= size_t(written);
+                while (written > 0) {
+                        Session::Chunk& chunk = session.output.front();
+                        size_t left = chunk.data->size() - chunk.offset;
+                        if (size_t(written) < left) {
+                                chunk.offset += size_t(written);
+                                break;
+                        }
+                        written -= ssize_t(left);
+                        session.output.pop_front();
+                }
+        }
+        // Only ask for EPOLLOUT while something is waiting, as it is reported all the time otherwise.
+        bool writeInterest = !session.output.empty();
+        if (writeInterest != session.writeInterest && !mStopping.load(std::memory_order_acquire)) {
+                session.writeInterest = writeInterest;
+                if (session.outputFd == session.inputFd) {
+                        epollControl(session.worker.epollFd, EPOLL_CTL_MOD, session.inputFd, EPOLLIN | (writeInterest ? uint32_t(EPOLLOUT) : 0), &session);
+                } else {
+                        epollControl(session.worker.epollFd, EPOLL_CTL_MOD, session.outputFd, writeInterest ? uint32_t(EPOLLOUT) : 0, &session);
+                }
+        }
+        return true;
+}
+
+void Reactor::removeSession(Worker& worker, Session* session) {
+        std::unique_ptr<Session> owned;
+        {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::vector<Session*>& sessions = session->group->sessions;
+                sessions.erase(std::remove(sessions.begin(), sessions.end(), session), sessions.end());
+                if (sessions.empty()) mGroups.erase(groupKey(session->group->size, session->group->capabilities));
+                {
+                        std::lock_guard<std::mutex> workerLock(worker.mutex);
+                        worker.mailbox.erase(std::remove(worker.mailbox.begin(), worker.mailbox.end(), session), worker.mailbox.end());
+                }
+                auto found = mSessions.find(session->id);
+                owned = std::move(found->second);
+                mSessions.erase(found);
+        }
+        // Restoring the terminal is only likely to get through if the session was closed on request.
+        owned->terminal.reset();
+        writeOutput(*owned);
+        worker.timers.erase(session);
+        for (int fd : {owned->inputFd, owned->outputFd, owned->resizeFd}) {
+                if (fd == -1) continue;
+                epollControl(worker.epollFd, EPOLL_CTL_DEL, fd, 0, nullptr);
+        }
+        owned->closeDescriptors();
+        mSessionsClosed.fetch_add(1, std::memory_order_relaxed);
+        if (mOnClosed) mOnClosed(owned->id);
+}
@@ -0,0 +1,113 @@
+#ifndef REACTOR_HPP_INCLUDED
+#define REACTOR_HPP_INCLUDED
+
+#include "screencanvas.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/** Counters of what a Reactor has done. */
+struct ReactorStats {
+        uint64_t sessionsOpened{0};
+        uint64_t sessionsClosed{0};
+        /** Frames drawn and encoded once per size, as changes from the previous frame and as complete repaints. */
+        uint64_t framesEncoded{0};
+        uint64_t keyframesEncoded{0};
+        /** Frames queued to a session, and frames a session missed since it had too much output queued. */
+        uint64_t framesSent{0};
+        uint64_t framesSkipped{0};
+        uint64_t bytesWritten{0};
+};
+
+/** Serves any number of terminals from one process, such as a dashboard shown to many SSH sessions. Each session has
+ * its own input parser, size and capabilities, which are those of the client's terminal rather than of this process:
+ * they come from the environment that the client tells about, such as over SSH, and from probing its terminal. Worker
+ * threads multiplex reading, parsing and writing with epoll, waking up in time for what a parser does without input,
+ * such as returning an ESC that nothing has followed as the escape key. A frame is drawn by renderFrame() once for
+ * each size and set of capabilities that sessions have, and the output is shared by all sessions with those that
+ * showed the previous frame. A session that falls behind is skipped instead of having output queued without limit, and
+ * is sent a repaint of the latest frame, encoded once for all such sessions, when it has caught up.
+ *
+ * Writing to a session that has gone away must not kill the process, so SIGPIPE is ignored. */
+class Reactor {
+        public:
+                /** Called on a worker thread with the id of the session and an event from it. */
+                using EventHandler = std::function<void(uint64_t session, Event const& event)>;
+                /** Called on a worker thread when a session has ended, after its descriptors are closed. */
+                using ClosedHandler = std::function<void(uint64_t session)>;
+
+                Reactor(unsigned int threads, EventHandler onEvent, ClosedHandler onClosed = nullptr);
+                ~Reactor();
+
+                /** Environment variables of the terminal of a session, such as TERM and COLORTERM. */
+                using Environment = std::map<std::string, std::string>;
+
+                /** Serve a terminal on the descriptors, which may be the same one, such as a socket or the terminal side of a
+                 * pseudo-terminal. They are made non-blocking and are closed when the session ends. If resizeFd is not -1,
+                 * it is read when readable and the size is then asked for again, for when something else learns about resizes,
+                 * such as a pipe from an SSH server. The environment is what the client has told about its terminal, such as
+                 * the variables an SSH client sends, which sets TRUE_COLOR from COLORTERM. If probe is set, the terminal
+                 * is also asked what it supports with Terminal::probeCapabilities(), which is cached by the environment,
+                 * and the session is given the frames for what it has replied once it has. Returns the id of the session. */
+                uint64_t addSession(int inputFd, int outputFd, int resizeFd = -1, Environment const& environment = Environment(), bool probe = false);
+                /** Set the size of a session, for when it is not known from the descriptors, such as for a socket. */
+                void setSessionSize(uint64_t session, Size size);
+                /** Restore the terminal of the session and close it. */
+                void closeSession(uint64_t session);
+                size_t sessionCount() const;
+
+                /** Call draw once for each size and set of capabilities that sessions have, and queue what has changed to
+                 * the sessions. The function is called again on another Terminal of the same size when sessions need a
+                 * repaint, so it must draw the same thing both times. Drawing and encoding happen without holding up the
+                 * workers, so a session that joins a group meanwhile gets its first frame from the next call. Only one
+                 * thread at a time may call this. */
+                void renderFrame(std::function<void(Terminal&)> const& draw);
+
+                ReactorStats stats() const;
+
+        private:
+                struct Session;
+                struct SizeGroup;
+                struct Worker;
+
+                EventHandler mOnEvent;
+                ClosedHandler mOnClosed;
+                std::vector<std::unique_ptr<Worker>> mWorkers;
+                unsigned int mNextWorker{0};
+                std::atomic<bool> mStopping{false};
+
+                /** Guards the sessions and the members of size groups, but not what is queued to be written to a session,
+                 * nor the Terminals of a group, which only renderFrame() uses. */
+                mutable std::mutex mMutex;
+                std::map<uint64_t, std::unique_ptr<Session>> mSessions;
+                /** By size and capabilities. Shared with renderFrame(), so that a group that loses its last session while
+                 * being drawn stays alive until it is done. */
+                std::map<std::pair<uint64_t, uint32_t>, std::shared_ptr<SizeGroup>> mGroups;
+                uint64_t mNextSession{1};
+
+                std::atomic<uint64_t> mSessionsOpened{0};
+                std::atomic<uint64_t> mSessionsClosed{0};
+                std::atomic<uint64_t> mFramesEncoded{0};
+                std::atomic<uint64_t> mKeyframesEncoded{0};
+                std::atomic<uint64_t> mFramesSent{0};
+                std::atomic<uint64_t> mFramesSkipped{0};
+                std::atomic<uint64_t> mBytesWritten{0};
+
+                void run(Worker& worker);
+                void wake(Worker& worker, Session* session);
+                /** Read and parse what has arrived, returning false if the input has ended. */
+                bool readInput(Session& session);
+                void parseInput(Session& session);
+                bool writeOutput(Session& session);
+                void removeSession(Worker& worker, Session* session);
+                /** Move a session to the group of its size and capabilities. Requires mMutex. */
+                void regroup(Session& session);
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "recording.hpp"
+#include "screencanvas.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Read an unsigned LEB128 varint, returning false if the data ends before it does. */
+static bool readVarint(uint8_t const*& data, uint8_t const* end, uint64_t& value) {
+        value = 0;
+        for (unsigned int shift = 0; data < end && shift < 64; shift += 7) {
+                uint8_t byte = *data++;
+                value |= uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+}
+
+bool Recording::load(char const* path) {
+        mData.clear();
+        mRecords.clear();
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat status;
+        if (fstat(fd, &status) < 0) {
+                int savedErrno = errno;
+                close(fd);
+                errno = savedErrno;
+                return false;
+        }
+        mData.resize(size_t(status.st_size));
+        size_t length = 0;
+        while (length < mData.size()) {
+                ssize_t bytesRead = ::read(fd, mData.data() + length, mData.size() - length);
+                if (bytesRead < 0 && errno == EINTR) continue;
+                if (bytesRead <= 0) break;
+                length += size_t(bytesRead);
+        }
+        close(fd);
+        mData.resize(length);
+
+        uint8_t const* data = mData.data();
+        uint8_t const* end = data + mData.size();
+        uint64_t rows, columns;
+        if (mData.size() < sizeof(MAGIC) + 1 || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[sizeof(MAGIC)] != VERSION) {
+                errno = EINVAL;
+                return false;
+        }
+        data += sizeof(MAGIC) + 1;
+        if (!readVarint(data, end, rows) || !readVarint(data, end, columns)) {
+                errno = EINVAL;
+                return false;
+        }
+        mInitialSize = Size{unsigned(rows), unsigned(columns)};
+
+        uint64_t time = 0;
+        while (data < end) {
+                Record record{Kind(*data++), 0, ByteSpan{nullptr, 0}, Size{0, 0}};
+                uint64_t delta, first, second;
+                if (!readVarint(data, end, delta)) break;
+                time += delta;
+                record.time = time;
+                if (record.kind == Kind::INPUT || record.kind == Kind::OUTPUT) {
+                        if (!readVarint(data, end, first) || first > uint64_t(end - data)) break;
+                        record.data = ByteSpan{data, size_t(first)};
+                        data += first;
+                } else if (record.kind == Kind::RESIZE) {
+                        if (!readVarint(data, end, first) || !readVarint(data, end, second)) break;
+                        record.size = Size{unsigned(first), unsigned(second)};
+                } else {
+                        // From a newer version, which cannot be skipped without knowing its length.
+                        break;
+                }
+                mRecords.push_back(record);
+        }
+        return true;
+}
+
+RecordingIo::RecordingIo(TerminalIo& io, char const* path) : mIo(io) {
+        mFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (mFd < 0) {
+                perror("open() of the recording failed");
+                exit(1);
+        }
+        if (!mIo.size(mRecordedSize)) mRecordedSize = Size{0, 0};
+        mBuffer.insert(mBuffer.end(), Recording::MAGIC, Recording::MAGIC + sizeof(Recording::MAGIC));
+        mBuffer.push_back(Recording::VERSION);
+        appendVarint(mRecordedSize.rows);
+        appendVarint(mRecordedSize.columns);
+        mLastRecordTime = Terminal::monotonicNanos() / 1000;
+}
+
+RecordingIo::~RecordingIo() {
+        flush();
+        close(mFd);
+}
+
+ssize_t RecordingIo::read(uint8_t* buffer, size_t capacity) {
+        ssize_t bytesRead = mIo.read(buffer, capacity);
+        if (bytesRead > 0) {
+                std::lock_guard<std::mutex> lock(mMutex);
+                beginRecord(Recording::Kind::INPUT);
+                appendVarint(uint64_t(bytesRead));
+                mBuffer.insert(mBuffer.end(), buffer, buffer + bytesRead);
+                if (mBuffer.size() >= FLUSH_THRESHOLD) writeBuffer();
+        }
+        return bytesRead;
+}
+
+unsigned int RecordingIo::write(char const* data, size_t length, size_t& written) {
+        unsigned int calls = mIo.write(data, length, written);
+        if (written > 0) {
+                int writeError = errno;
+                std::lock_guard<std::mutex> lock(mMutex);
+                beginRecord(Recording::Kind::OUTPUT);
+                appendVarint(written);
+                mBuffer.insert(mBuffer.end(), data, data + written);
+                if (mBuffer.size() >= FLUSH_THRESHOLD) writeBuffer();
+                errno = writeError;
+        }
+        return calls;
+}
+
+bool RecordingIo::size(Size& size) {
+        if (!mIo.size(size)) return false;
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (size.rows != mRecordedSize.rows || size.columns != mRecordedSize.columns) {
+                beginRecord(Recording::Kind::RESIZE);
+                appendVarint(size.rows);
+                appendVarint(size.columns);
+                mRecordedSize = size;
+        }
+        return true;
+}
+
+void RecordingIo::flush() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        writeBuffer();
+}
+
+void RecordingIo::beginRecord(Recording::Kind kind) {
+        uint64_t now = Terminal::monotonicNanos() / 1000;
+        mBuffer.push_back(uint8_t(kind));
+        appendVarint(now - mLastRecordTime);
+        mLastRecordTime = now;
+}
+
+void RecordingIo::appendVarint(uint64_t value) {
+        while (value >= 0x80) {
+                mBuffer.push_back(uint8_t(value | 0x80));
+                value >>= 7;
+        }
+        mBuffer.push_back(uint8_t(value));
+}
+
+void RecordingIo::writeBuffer() {
+        size_t written = 0;
+        while (written < mBuffer.size()) {
+                ssize_t result = ::write(mFd, mBuffer.data() + written, mBuffer.size() - written);
+                if (result < 0 && errno == EINTR) continue;
+                if (result < 0) {
+                        perror("write() of the recording failed");
+                        exit(1);
+                }
+                written += size_t(result);
+        }
+        mBuffer.clear();
+}
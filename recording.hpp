@@ -0,0 +1,89 @@
+#ifndef RECORDING_HPP_INCLUDED
+#define RECORDING_HPP_INCLUDED
+
+#include "terminalio.hpp"
+
+#include <mutex>
+#include <vector>
+
+/** A session recorded by a RecordingIo, read into memory.
+ *
+ * A recording starts with the 8 bytes of MAGIC, a version byte and the size of the screen as rows and columns. Then follow
+ * records of a kind byte and the microseconds since the previous record, followed by the bytes of INPUT or OUTPUT with
+ * their length first, or the new rows and columns of a RESIZE. All numbers are unsigned LEB128 varints, so that the
+ * record of a keypress takes a handful of bytes. */
+class Recording {
+        public:
+                static constexpr char MAGIC[8] = {'S', 'C', 'R', 'E', 'C', 'O', 'R', 'D'};
+                static constexpr uint8_t VERSION = 1;
+                enum class Kind : uint8_t { INPUT, OUTPUT, RESIZE };
+
+                struct Record {
+                        Kind kind;
+                        /** Microseconds since the recording started. */
+                        uint64_t time;
+                        /** For INPUT and OUTPUT, the bytes, which stay valid as long as the Recording. */
+                        ByteSpan data;
+                        /** For RESIZE, the new size. */
+                        Size size;
+                };
+
+                /** Read the file at path, returning false with errno set if it could not be read, or EINVAL if it is not a
+                 * recording. A record cut short, as when the recording process was killed, ends the recording. */
+                bool load(char const* path);
+
+                /** The size of the screen when recording started, which is {0, 0} if it was not known. */
+                Size initialSize() const { return mInitialSize; }
+                std::vector<Record> const& records() const { return mRecords; }
+                /** Microseconds from the start of the recording to the last record. */
+                uint64_t duration() const { return mRecords.empty() ? 0 : mRecords.back().time; }
+        private:
+                std::vector<uint8_t> mData;
+                std::vector<Record> mRecords;
+                Size mInitialSize{0, 0};
+};
+
+/** Records what goes through another TerminalIo, the raw input read and output written along with when it happened and
+ * changes of the size, into a file that the replay program plays back. Records are buffered and written to the file
+ * when enough has been collected, by flush() and when destroyed. Reads and writes may happen on different threads, as
+ * with a ThreadedTerminal.
+ *
+ * A Terminal created without a TerminalIo records to the file named by the SCREENCANVAS_RECORD_FILE environment
+ * variable, if set. */
+class RecordingIo : public TerminalIo {
+        public:
+                /** Record io, which must outlive this, into the file at path, which is replaced. Exits if it cannot be created. */
+                RecordingIo(TerminalIo& io, char const* path);
+                ~RecordingIo();
+
+                unsigned int wait(uint64_t deadline) override { return mIo.wait(deadline); }
+                ssize_t read(uint8_t* buffer, size_t capacity) override;
+                /** Only what io accepted is recorded, so that a recording never shows output the terminal did not get. */
+                unsigned int write(char const* data, size_t length, size_t& written) override;
+                bool size(Size& size) override;
+                void setRawMode(bool raw) override { mIo.setRawMode(raw); }
+                char const* environment(char const* name) override { return mIo.environment(name); }
+                bool wakeable() const override { return mIo.wakeable(); }
+                void wakeUp() override { mIo.wakeUp(); }
+
+                /** Write the records collected so far to the file. */
+                void flush();
+        private:
+                TerminalIo& mIo;
+                int mFd;
+                /** Guards the records not yet written to the file, and what the next record is relative to. */
+                std::mutex mMutex;
+                std::vector<uint8_t> mBuffer;
+                uint64_t mLastRecordTime;
+                Size mRecordedSize{0, 0};
+                /** Records are written to the file when this much has been collected. */
+                static const size_t FLUSH_THRESHOLD = 64 * 1024;
+
+                /** Start a record of the kind. Requires mMutex. */
+                void beginRecord(Recording::Kind kind);
+                void appendVarint(uint64_t value);
+                /** Write mBuffer to the file. Requires mMutex. */
+                void writeBuffer();
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "recording.hpp"
+#include "screencanvas.hpp"
+
+#include <errno.h>
+
+#include <algorithm>
+
+// Plays back a session recorded with SCREENCANVAS_RECORD_FILE set, or by a RecordingIo. The recorded input is parsed
+// by a Terminal, as the recorded program did. By default this happens as fast as possible into a MemoryIo, repeated
+// --repeat times, and the parsing throughput and the sizes of the recorded frames are printed as a JSON object, so that
+// recordings of real sessions can serve as benchmarks of parsing and of output size. With --realtime the recorded
+// output is written as well, to stdout with the recorded timing, to watch the session, and the JSON object goes to stderr.
+
+static void usage() {
+        fprintf(stderr, "usage: replay [--realtime] [--repeat N] [--text-runs] RECORDING\n");
+        exit(2);
+}
+
+/** What one pass over the recording did. */
+struct Totals {
+        uint64_t inputBytes{0};
+        uint64_t events{0};
+        uint64_t parseNanos{0};
+};
+
+static void writeAll(int fd, ByteSpan data) {
+        while (data.length > 0) {
+                ssize_t written = write(fd, data.data, data.length);
+                if (written < 0 && errno == EINTR) continue;
+                if (written < 0) {
+                        perror("write() failed");
+                        exit(1);
+                }
+                data.data += written;
+                data.length -= size_t(written);
+        }
+}
+
+/** Parse all events that the input fed so far gives. */
+static uint64_t drainEvents(Terminal& term) {
+        uint64_t events = 0;
+        while (term.await(0) != EventType::TIMEOUT) events++;
+        return events;
+}
+
+static Totals replay(Recording const& recording, bool realtime, bool textRuns) {
+        Size size = recording.initialSize();
+        if (size.rows == 0 || size.columns == 0) size = Size{24, 80};
+        MemoryIo io(size);
+        Totals totals;
+        {
+                Terminal term(io);
+                // Recorded reads are where the input arrived in pieces, so an ESC that ends one was alone at the time.
+                term.setAutoPresent(false).setEscapeTimeout(0).setTextRuns(textRuns);
+                io.clearOutput();
+                uint64_t start = Terminal::monotonicNanos();
+                for (Recording::Record const& record : recording.records()) {
+                        if (realtime) {
+                                uint64_t due = start + record.time * 1000, now = Terminal::monotonicNanos();
+                                if (due > now) usleep(useconds_t((due - now) / 1000));
+                        }
+                        switch (record.kind) {
+                                case Recording::Kind::INPUT: {
+                                        uint64_t parseStart = Terminal::monotonicNanos();
+                                        io.feed(record.data.data, record.data.length);
+                                        totals.events += drainEvents(term);
+                                        totals.inputBytes += record.data.length;
+                                        totals.parseNanos += Terminal::monotonicNanos() - parseStart;
+                                        break;
+                                }
+                                case Recording::Kind::OUTPUT:
+                                        // The output was encoded by the recorded program, so only its size is of
+                                        // interest, which is known without replaying it.
+                                        if (realtime) writeAll(STDOUT_FILENO, record.data);
+                                        break;
+                                case Recording::Kind::RESIZE:
+                                        io.setSize(record.size);
+                                        totals.events += drainEvents(term);
+                                        break;
+                        }
+                }
+        }
+        return totals;
+}
+
+int main(int argc, char** argv) {
+        bool realtime = false, textRuns = false;
+        unsigned int repeat = 1;
+        char const* path = nullptr;
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--realtime") == 0) {
+                        realtime = true;
+                } else if (strcmp(argv[i], "--text-runs") == 0) {
+                        textRuns = true;
+                } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+                        repeat = unsigned(atoi(argv[++i]));
+                        if (repeat == 0) usage();
+                } else if (argv[i][0] == '-' || path != nullptr) {
+                        usage();
+                } else {
+                        path = argv[i];
+                }
+        }
+        if (path == nullptr) usage();
+        Recording recording;
+        if (!recording.load(path)) {
+                fprintf(stderr, "replay: %s: %s\n", path, errno == EINVAL ? "not a recording" : strerror(errno));
+                return 1;
+        }
+        if (realtime) repeat = 1;
+
+        Totals totals;
+        uint64_t start = Terminal::monotonicNanos();
+        for (unsigned int pass = 0; pass < repeat; pass++) {
+                Totals passTotals = replay(recording, realtime, textRuns);
+                totals.inputBytes += passTotals.inputBytes;
+                totals.events += passTotals.events;
+                totals.parseNanos += passTotals.parseNanos;
+        }
+        uint64_t replayNanos = Terminal::monotonicNanos() - start;
+
+        // Each recorded write is one flush of the Terminal, which is one frame when presenting.
+        std::vector<size_t> frames;
+        for (Recording::Record const& record : recording.records()) {
+                if (record.kind == Recording::Kind::OUTPUT) frames.push_back(record.data.length);
+        }
+        std::sort(frames.begin(), frames.end());
+        auto percentile = [&frames](double fraction) { return frames.empty() ? 0 : frames[size_t(fraction * (frames.size() - 1))]; };
+        uint64_t frameBytes = 0;
+        for (size_t frame : frames) frameBytes += frame;
+
+        FILE* report = realtime ? stderr : stdout;
+        fprintf(report, "{\"recording\": \"%s\", \"duration_ms\": %.1f, \"passes\": %u, \"input_bytes\": %llu, \"events\": %llu, "
+                        "\"parse_ns_per_byte\": %.2f, \"parse_mb_per_s\": %.2f, \"frames\": %zu, \"output_bytes\": %llu, "
+                        "\"frame_bytes_mean\": %.1f, \"frame_bytes_p50\": %zu, \"frame_bytes_p99\": %zu, "
+                        "\"frame_bytes_max\": %zu, \"replay_ms\": %.1f}\n",
+                        path, recording.duration() / 1000.0, repeat, (unsigned long long) (totals.inputBytes / repeat),
+                        (unsigned long long) (totals.events / repeat),
+                        totals.inputBytes ? double(totals.parseNanos) / totals.inputBytes : 0.0,
+                        totals.parseNanos ? totals.inputBytes * 1000.0 / totals.parseNanos : 0.0,
+                        frames.size(), (unsigned long long) frameBytes,
+                        frames.empty() ? 0.0 : double(frameBytes) / frames.size(), percentile(0.5), percentile(0.99),
+                        frames.empty() ? 0 : frames.back(), replayNanos / 1e6);
+        return 0;
+}
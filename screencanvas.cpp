@@ -1,274 +1,2221 @@
 #include "screencanvas.hpp"
+#include "capabilitycache.hpp"
+#include "recording.hpp"
+
+#include <algorithm>
 
 #include <errno.h>
-#include <signal.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/ioctl.h>
+#include <time.h>
 
-static struct winsize global_termsize;
-static bool global_termsize_changed = false;
+uint64_t Terminal::monotonicNanos() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
 
-static void sigwinch_handler(int)
-{
-        if (ioctl(STDIN_FILENO, TIOCGWINSZ, (char*) &global_termsize) < 0) {
-                perror("ioctl() failed");
-                exit(1);
-        }
-        global_termsize_changed = true;
+/** stdin and stdout, shared by the Terminals that use them, and recorded into the file named by the
+ * SCREENCANVAS_RECORD_FILE environment variable if set. */
+static TerminalIo& standardIo() {
+        static FdIo io(STDIN_FILENO, STDOUT_FILENO);
+        static char const* recordFile = getenv("SCREENCANVAS_RECORD_FILE");
+        if (recordFile == nullptr || *recordFile == '\0') return io;
+        static RecordingIo recording(io, recordFile);
+        return recording;
 }
 
+Terminal::Terminal() : Terminal(standardIo()) {
+}
 
-Terminal::Terminal() {
-        struct winsize termSize;
-        if (ioctl(STDIN_FILENO, TIOCGWINSZ, (char*) &termSize) < 0) {
-                perror("ioctl() failed");
-                exit(1);
-        }
-        mRows = termSize.ws_row;
-        mColumns = termSize.ws_col;
-
-        tcgetattr(0, &vt_orig); /* get the current settings */
-        struct termios trm = vt_orig;
-        trm.c_cc[VMIN] = 1; 	// Minimum number of characters for noncanonical read (MIN).
-        trm.c_cc[VTIME] = 0; 	// Timeout in deciseconds for noncanonical read (TIME).
-        // echo off, canonical mode off, extended input processing off, signal chars off:
-        trm.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
-        tcsetattr(STDIN_FILENO, TCSANOW, &trm);
-
-        struct sigaction newSigAction;
-        newSigAction.sa_handler = sigwinch_handler;
-        newSigAction.sa_mask = 0;
-        newSigAction.sa_flags = 0;
-        struct sigaction oldSigAction;
-        if (sigaction(SIGWINCH, &newSigAction, &oldSigAction) < 0) {
-                perror("sigaction() failed");
-                exit(1);
-        }
+Terminal::Terminal(TerminalIo& io) : mIo(io) {
+        // Without a terminal to ask, such as when writing to a pipe, assume the traditional size.
+        Size size{24, 80};
+        mIo.size(size);
+        mRows = size.rows;
+        mColumns = size.columns;
+
+        // The convention for telling that a terminal supports 24-bit colors.
+        char const* colorTerm = mIo.environment("COLORTERM");
+        if (colorTerm != nullptr && (strcmp(colorTerm, "truecolor") == 0 || strcmp(colorTerm, "24bit") == 0)) setCapability(Capability::TRUE_COLOR, true);
 
+        mIo.setRawMode(true);
+
+#if SCREENCANVAS_STATS
+        char const* statsFile = getenv("SCREENCANVAS_STATS_FILE");
+        if (statsFile != nullptr && *statsFile != '\0') {
+                mStatsDumpFd = open(statsFile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (mStatsDumpFd < 0) perror("open(SCREENCANVAS_STATS_FILE)");
+                mStatsDumpFdOwned = (mStatsDumpFd >= 0);
+        }
+#endif
 }
 
 Terminal::~Terminal() {
-        tcsetattr(0, TCSANOW, &vt_orig);
-        if (cursor_app_set) printf("\033[?1l");
-        if (keypad_app_set) printf("\033[?66l"); // CSI ? 1 h, Application Cursor Keys
-        if (bracketed_paste_mode) printf("\033[?2004l");
+        setRetainedMode(false);
+        mIo.setRawMode(false);
+        if (cursor_app_set) emit<Csi::DECRST>(1);
+        if (keypad_app_set) emit<Csi::DECRST>(66); // CSI ? 1 h, Application Cursor Keys
+        if (bracketed_paste_mode) decPrivateMode(2004, false);
         if (cursor_hidden) showCursor();
         if (mouse_enabled) disableMouse();
-        setForeground(Color::DEFAULT).setBackground(Color::DEFAULT);
+        if (focus_reporting) setFocusReporting(false);
+        presentStyle(Style());
         if (alt_screen_set) leaveAltScreen();
-        fflush(stdout);
+        flush();
+#if SCREENCANVAS_STATS
+        if (mStatsDumpFd >= 0) mStats.dump(mStatsDumpFd);
+        if (mStatsDumpFdOwned) close(mStatsDumpFd);
+#endif
 }
 
-EventType Terminal::await() {
-        mLastEventType = EventType::NONE;
-        while (mLastEventType == EventType::NONE) {
-                if (mReadBufferLength == 0) {
-                        int bytesRead = read(STDIN_FILENO, mReadBuffer + mReadBufferOffset, sizeof(mReadBuffer) - mReadBufferOffset - mReadBufferLength);
+TerminalStats const& Terminal::stats() const {
+#if SCREENCANVAS_STATS
+        return mStats;
+#else
+        static const TerminalStats NO_STATS;
+        return NO_STATS;
+#endif
+}
+
+Terminal& Terminal::setStatsDumpFd(int fd) {
+#if SCREENCANVAS_STATS
+        if (mStatsDumpFdOwned) close(mStatsDumpFd);
+        mStatsDumpFd = fd;
+        mStatsDumpFdOwned = false;
+#else
+        (void) fd;
+#endif
+        return *this;
+}
+
+EventType Terminal::await(int timeoutMilliseconds) {
+        return awaitUntil(timeoutMilliseconds < 0 ? UINT64_MAX : monotonicNanos() + uint64_t(timeoutMilliseconds) * 1000000);
+}
+
+EventType Terminal::awaitUntil(uint64_t deadline) {
+        if (mAutoPresent) present();
+        flush();
+        mSpansHandedOut = false;
+        readEvent(deadline);
+        return mEvent.type;
+}
+
+size_t Terminal::awaitBatch(Event* events, size_t capacity, int timeoutMilliseconds) {
+        if (mAutoPresent) present();
+        flush();
+        mSpansHandedOut = false;
+        size_t count = 0;
+        uint64_t deadline = timeoutMilliseconds < 0 ? UINT64_MAX : monotonicNanos() + uint64_t(timeoutMilliseconds) * 1000000;
+        // Wait for the first event, then take what is available without blocking.
+        while (count < capacity && readEvent(count == 0 ? deadline : 0)) {
+                bool motion = (mEvent.type == EventType::MOUSE_MOVED || mEvent.type == EventType::MOUSE_MOVED_PRESSED);
+                if (motion && count > 0 && events[count - 1].type == mEvent.type && events[count - 1].mouseButton == mEvent.mouseButton
+                                && events[count - 1].modifiers == mEvent.modifiers) {
+                        // Only the latest position of consecutive motion is of interest.
+                        events[count - 1] = mEvent;
+                } else {
+                        events[count++] = mEvent;
+                }
+                // Spans in the returned events must stay valid while reading more.
+                mSpansHandedOut = true;
+                if (mEvent.type == EventType::INPUT_ENDED) break;
+        }
+        return count;
+}
+
+bool Terminal::readEvent(uint64_t deadline) {
+        mEvent = Event();
+        if (mProbeEventPending) {
+                mProbeEventPending = false;
+                mEvent.type = EventType::CAPABILITIES;
+        }
+        while (mEvent.type == EventType::NONE) {
+                if (mReadBufferLength == 0 || mInputIncomplete) {
+                        if (mInputEnded) {
+                                inputEnded();
+                                break;
+                        }
+                        // An ESC is only known to be the escape key when nothing has followed it for a while.
+                        bool escapePending = escapeTimeoutPending();
+                        if (escapePending && mEscapeDeadline == 0) mEscapeDeadline = monotonicNanos() + uint64_t(mEscapeTimeoutMilliseconds) * 1000000;
+                        uint64_t waitDeadline = escapePending ? std::min(deadline, mEscapeDeadline) : deadline;
+                        if (mProbeDeadline != 0) waitDeadline = std::min(waitDeadline, mProbeDeadline);
+                        IF_STATS(uint64_t waitStart = monotonicNanos());
+                        unsigned int ready = mIo.wait(waitDeadline);
+                        IF_STATS(mStats.awaitBlocked.record(monotonicNanos() - waitStart));
+                        if (ready & TerminalIo::FAILED) {
+                                mInputEnded = true;
+                                mInputError = errno;
+                                continue;
+                        }
+                        if (ready == 0 && escapePending && monotonicNanos() >= mEscapeDeadline) {
+                                escapeTimedOut();
+                                break;
+                        }
+                        if (ready == 0 && mProbeDeadline != 0 && monotonicNanos() >= mProbeDeadline) {
+                                finishProbe(false);
+                                break;
+                        }
+                        if (ready == 0) {
+                                mEvent.type = EventType::TIMEOUT;
+                                IF_STATS(mStats.events[size_t(EventType::TIMEOUT)]++);
+                                return false;
+                        }
+
+                        if (ready & TerminalIo::RESIZE) {
+                                if (checkResize()) {
+                                        mEvent.type = EventType::RESIZE;
+                                        mEvent.size = Size{mRows, mColumns};
+                                        break;
+                                }
+                                if (!(ready & TerminalIo::INPUT)) continue;
+                        }
+
+                        if (!mSpansHandedOut && mReadBufferOffset > 0) {
+                                // Keep what is left at the start of the buffer and read more after it.
+                                memmove(mReadBuffer.data(), mReadBuffer.data() + mReadBufferOffset, mReadBufferLength);
+                                mReadBufferOffset = 0;
+                        }
+                        size_t readOffset = mReadBufferOffset + mReadBufferLength;
+                        if (readOffset == mReadBuffer.size()) {
+                                // No room without moving data that spans refer to, so wait for the next call.
+                                mEvent.type = EventType::TIMEOUT;
+                                IF_STATS(mStats.events[size_t(EventType::TIMEOUT)]++);
+                                return false;
+                        }
+                        mInputIncomplete = false;
+                        ssize_t bytesRead = mIo.read(mReadBuffer.data() + readOffset, mReadBuffer.size() - readOffset);
                         if (bytesRead == 0) {
-                                perror("read(0");
-                                exit(1);
+                                mInputEnded = true;
                         } else if (bytesRead < 0) {
-                                if (errno == EINTR && global_termsize_changed) {
-                                        mLastEventType = EventType::RESIZE;
-                                        mRows = global_termsize.ws_row;
-                                        mColumns = global_termsize.ws_col;
-                                        global_termsize_changed = false;
-                                } else {
-                                        print("READ SIGNAL");
-                                        perror("read()");
-                                        exit(1);
+                                if (errno != EINTR && errno != EAGAIN) {
+                                        mInputEnded = true;
+                                        mInputError = errno;
                                 }
                         } else {
                                 mReadBufferLength += bytesRead;
+                                mEscapeDeadline = 0;
+                                IF_STATS(mInputReadTime = monotonicNanos());
+                                IF_STATS(mStats.bytesRead += bytesRead);
                         }
+                        IF_STATS(mStats.readCalls++);
                 }
 
-                while (mLastEventType == EventType::NONE && mReadBufferLength > 0) {
-                        processByte(mReadBuffer[mReadBufferOffset]);
-                        if (--mReadBufferLength == 0) {
-                                mReadBufferOffset = 0;
-                        } else {
-                                mReadBufferOffset++;
+                while (mEvent.type == EventType::NONE && mReadBufferLength > 0 && !mInputIncomplete) {
+                        unsigned int consumed = 1;
+                        if (mPasting) {
+                                consumed = processPaste();
+                        } else if (mTextRuns && mEscapeState == EscapeState::GROUND && mUtf8Index == 0) {
+                                size_t textLength = scanText(&mReadBuffer[mReadBufferOffset], mReadBufferLength);
+                                if (textLength > 0) {
+                                        mEvent.text = ByteSpan{&mReadBuffer[mReadBufferOffset], textLength};
+                                        mEvent.type = EventType::TEXT;
+                                        consumed = textLength;
+                                }
+                        }
+                        if (consumed == 1 && mEvent.type == EventType::NONE && !mPasting && !processByte(mReadBuffer[mReadBufferOffset])) {
+                                consumed = 0;
                         }
+                        mReadBufferLength -= consumed;
+                        mReadBufferOffset = (mReadBufferLength == 0 && !mSpansHandedOut) ? 0 : mReadBufferOffset + consumed;
                 }
         }
-        return mLastEventType;
+        IF_STATS(mStats.events[size_t(mEvent.type)]++);
+        IF_STATS(if (mEvent.type != EventType::RESIZE && mUnpresentedInputTime == 0) mUnpresentedInputTime = mInputReadTime);
+        return true;
+}
+
+void Terminal::inputEnded() {
+        if (escapeTimeoutPending()) {
+                // Nothing can follow an ESC any more.
+                escapeTimedOut();
+                return;
+        }
+        if (mPasting) {
+                // The end marker will not come, so what was held back in case it started it is the end of the paste.
+                mEvent.text = ByteSpan{&mReadBuffer[mReadBufferOffset], mReadBufferLength};
+                mEvent.pasteFinished = true;
+                mEvent.type = EventType::PASTE;
+                mPasting = false;
+        } else {
+                mEvent.type = EventType::INPUT_ENDED;
+                mEvent.error = mInputError;
+        }
+        // Drop what is left of an incomplete sequence or character.
+        mReadBufferOffset = mSpansHandedOut ? mReadBufferOffset + mReadBufferLength : 0;
+        mReadBufferLength = 0;
+        mInputIncomplete = false;
+        mEscapeState = EscapeState::GROUND;
+        mEscapeModifiers = 0;
+        mUtf8Index = 0;
+}
+
+bool Terminal::checkResize() {
+        drawOn(nullptr);
+        Size size;
+        if (!mIo.size(size)) return false;
+        if (size.rows == mRows && size.columns == mColumns) return false;
+        mRows = size.rows;
+        mColumns = size.columns;
+        resizeScreenModel();
+        return true;
+}
+
+unsigned int Terminal::processPaste() {
+        static char const END_MARKER[] = "\033[201~";
+        static size_t const END_MARKER_LENGTH = sizeof(END_MARKER) - 1;
+
+        uint8_t const* data = &mReadBuffer[mReadBufferOffset];
+        uint8_t const* end = data + mReadBufferLength;
+        uint8_t const* chunkEnd = end;
+        bool finished = false;
+        for (uint8_t const* escape = data; (escape = (uint8_t const*) memchr(escape, 27, end - escape)) != nullptr; escape++) {
+                size_t available = end - escape;
+                if (available >= END_MARKER_LENGTH) {
+                        if (memcmp(escape, END_MARKER, END_MARKER_LENGTH) == 0) {
+                                chunkEnd = escape;
+                                finished = true;
+                                break;
+                        }
+                } else if (memcmp(escape, END_MARKER, available) == 0) {
+                        // What may be the start of the end marker is held back until more has been read.
+                        chunkEnd = escape;
+                        break;
+                }
+        }
+
+        size_t chunkLength = chunkEnd - data;
+        if (chunkLength == 0 && !finished) {
+                mInputIncomplete = true;
+                return 0;
+        }
+        mEvent.text = ByteSpan{data, chunkLength};
+        mEvent.pasteFinished = finished;
+        mEvent.type = EventType::PASTE;
+        if (finished) mPasting = false;
+        return chunkLength + (finished ? END_MARKER_LENGTH : 0);
 }
 
 Terminal& Terminal::moveCursor(int right, int up) {
+        if (mRetained) {
+                int row = int(mCursorRow) - up;
+                int column = int(mCursorColumn) + right;
+                mCursorRow = row < 0 ? 0 : (row >= int(mRows) ? mRows - 1 : row);
+                mCursorColumn = column < 0 ? 0 : (column >= int(mColumns) ? mColumns - 1 : column);
+                mWrapPending = false;
+                return *this;
+        }
         // CSI Ps A Cursor Up Ps Times (default = 1) (CUU).
         // CSI Ps B Cursor Down Ps Times (default = 1) (CUD).
         // CSI Ps C Cursor Forward Ps Times (default = 1) (CUF).
         // CSI Ps D Cursor Backward Ps Times (default = 1) (CUB).
-        if (up != 0) printf("\033[%d%c", up > 0 ? up : -up, up > 0 ? 'A' : 'B');
-        if (right != 0) printf("\033[%d%c", right > 0 ? right : -right, right > 0 ? 'C' : 'D');
-        fflush(stdout);
+        if (up > 0) emit<Csi::CUU>(up); else if (up < 0) emit<Csi::CUD>(-up);
+        if (right > 0) emit<Csi::CUF>(right); else if (right < 0) emit<Csi::CUB>(-right);
         return *this;
 }
 
+/** A cell of the front buffer that is never equal to one of the back buffer, so that it is always drawn. */
+static const Cell UNKNOWN_CELL(Cell::UNKNOWN, 0);
+
+/** If DECFRA can fill with the character, which xterm limits to those that are the same in Latin-1. */
+static bool fillableByDecfra(uint32_t codepoint) {
+        return (codepoint >= 32 && codepoint <= 126) || (codepoint >= 160 && codepoint <= 255);
+}
+
+/** If the character is known to take up one cell, so that repeating it moves the cursor one column per repetition.
+ * Emoji and regional indicators are left out, since terminals disagree on their width. */
+static bool knownSingleWidth(uint32_t codepoint) {
+        if (codepoint < 0x80) return codepoint >= 32 && codepoint <= 126;
+        return codepoint <= 0x10FFFF && codepointWidth(codepoint) == 1 && graphemeBreak(codepoint) == GraphemeBreak::OTHER;
+}
+
 void Terminal::fillRectangle(unsigned int left, unsigned int top, unsigned int right, unsigned int bottom, uint32_t codepoint) {
         clipToScreen(top, left);
         clipToScreen(bottom, right);
         if (bottom >= top || left >= right) return;
-        print("\033[%d;%d;%d;%d;%d$x", codepoint, bottom, left, top, right);
+        // The cells covered by the DECFRA sequence below, as half open ranges of rows from the top and columns.
+        unsigned int firstRow = bottom - 1, endRow = top, firstColumn = left > 0 ? left - 1 : 0, endColumn = right;
+        if (mRetained) {
+                mBackBuffer.fillRectangle(firstRow, firstColumn, endRow, endColumn, Cell(codepoint, styleIndex()));
+                damage(firstRow, firstColumn, endRow, endColumn);
+                return;
+        }
+        presentStyle(mStyle);
+        if (hasCapability(Capability::RECTANGULAR_EDITING) && fillableByDecfra(codepoint)) {
+                emit<Csi::DECFRA>(codepoint, bottom, left, top, right);
+                return;
+        }
+        // Draw the rows one at a time instead, leaving the cursor where it was like DECFRA does.
+        char utf8[4];
+        size_t utf8Length = writeUtf8(utf8, codepoint) - utf8;
+        unsigned int count = endColumn - firstColumn;
+        bool repeat = count > 1 && hasCapability(Capability::REPEAT) && knownSingleWidth(codepoint);
+        emit("\0337"); // DECSC - Save Cursor.
+        for (unsigned int row = firstRow; row < endRow; row++) {
+                emit<Csi::CUP>(row + 1, firstColumn + 1);
+                if (repeat) {
+                        mOutput.append(utf8, utf8Length);
+                        emit<Csi::REP>(count - 1);
+                } else {
+                        for (unsigned int i = 0; i < count; i++) mOutput.append(utf8, utf8Length);
+                        outputWritten();
+                }
+        }
+        emit("\0338"); // DECRC - Restore Cursor.
+}
+
+Terminal& Terminal::copyRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, unsigned int toColumn, unsigned int toRow) {
+        if (row >= mRows || toRow >= mRows || column >= mColumns || toColumn >= mColumns) return *this;
+        // Clip the size so that both the source and the destination are on the screen.
+        rows = std::min({rows, mRows - row, mRows - toRow});
+        columns = std::min({columns, mColumns - column, mColumns - toColumn});
+        if (rows == 0 || columns == 0) return *this;
+        unsigned int top = mRows - row - rows, toTop = mRows - toRow - rows;
+        if (mRetained) {
+                mBackBuffer.copyRectangle(top, column, top + rows, column + columns, toTop, toColumn);
+                damage(toTop, toColumn, toTop + rows, toColumn + columns);
+                // Copies on a canvas end up wherever the canvas is composited, which is only known when presenting.
+                if (mCanvas == nullptr && mCopyHints.size() < MAX_COPY_HINTS) mCopyHints.push_back(CopyHint{top, column, top + rows, column + columns, toTop, toColumn});
+        } else if (hasCapability(Capability::RECTANGULAR_EDITING)) {
+                emit<Csi::DECCRA>(top + 1, column + 1, top + rows, column + columns, 1, toTop + 1, toColumn + 1, 1);
+        }
+        return *this;
+}
+
+namespace {
+
+/** What the input parser does with a byte, besides moving to the next state. */
+enum class InputAction : uint8_t { NONE, CHARACTER, UTF8, ALT_ESCAPE, ALT_CHARACTER, ALT_UTF8, SEQUENCE_START, PRIVATE_MARKER,
+        PARAM_DIGIT, PARAM_NEXT, INTERMEDIATE, CSI_DISPATCH, SS3_DISPATCH, IGNORE_START, IGNORE_END, ABORT, DCS_START, DCS_COLLECT,
+        DCS_DISPATCH, DCS_ABORT };
+/** The classes of bytes that the input parser tells apart. */
+enum class ByteClass : uint8_t { CONTROL, ESCAPE, INTERMEDIATE, DIGIT, COLON, SEMICOLON, PRIVATE, BRACKET, LETTER_O, LETTER_P, BACKSLASH,
+        FINAL, DELETE, HIGH, COUNT };
+
+struct InputTransition {
+        EscapeState state;
+        InputAction action;
+};
+
+constexpr ByteClass byteClass(unsigned int byte) {
+        if (byte == 27) return ByteClass::ESCAPE;
+        if (byte < 0x20) return ByteClass::CONTROL;
+        if (byte < 0x30) return ByteClass::INTERMEDIATE;
+        if (byte < 0x3A) return ByteClass::DIGIT;
+        if (byte == ':') return ByteClass::COLON;
+        if (byte == ';') return ByteClass::SEMICOLON;
+        if (byte < 0x40) return ByteClass::PRIVATE;
+        if (byte == '[') return ByteClass::BRACKET;
+        if (byte == 'O') return ByteClass::LETTER_O;
+        if (byte == 'P') return ByteClass::LETTER_P;
+        if (byte == '\\') return ByteClass::BACKSLASH;
+        if (byte < 0x7F) return ByteClass::FINAL;
+        if (byte == 0x7F) return ByteClass::DELETE;
+        return ByteClass::HIGH;
 }
 
-void Terminal::processByte(uint8_t byte) {
-        switch (mEscapeState) {
-                case EscapeState::NONE:
-                        if (byte == 27) {
-                                mEscapeState = EscapeState::ESCAPE;
+/** The transition from the state on a byte of the class, which follows the DEC parser that ECMA-48 sequences are
+ * commonly parsed with. A sequence cut short by a control character, ESC or non-ASCII byte is dropped, and the
+ * byte is processed again, while a sequence with bytes in the wrong place is skipped up to its final byte. */
+constexpr InputTransition inputTransition(EscapeState state, ByteClass byteClass) {
+        using S = EscapeState;
+        using A = InputAction;
+        using C = ByteClass;
+        switch (state) {
+                case S::GROUND:
+                        if (byteClass == C::ESCAPE) return {S::ESCAPE, A::NONE};
+                        return {S::GROUND, byteClass == C::HIGH ? A::UTF8 : A::CHARACTER};
+                case S::ESCAPE:
+                        // ESC before a character or another sequence is how terminals send it with alt held down.
+                        switch (byteClass) {
+                                case C::ESCAPE: return {S::ESCAPE, A::ALT_ESCAPE};
+                                case C::BRACKET: return {S::CSI_ENTRY, A::SEQUENCE_START};
+                                case C::LETTER_O: return {S::SS3, A::SEQUENCE_START};
+                                case C::LETTER_P: return {S::DCS_STRING, A::DCS_START};
+                                case C::HIGH: return {S::GROUND, A::ALT_UTF8};
+                                default: return {S::GROUND, A::ALT_CHARACTER};
+                        }
+                case S::DCS_STRING:
+                        // Replies such as that to XTVERSION, which end with ST, that is ESC \.
+                        return byteClass == C::ESCAPE ? InputTransition{S::DCS_ESCAPE, A::NONE} : InputTransition{S::DCS_STRING, A::DCS_COLLECT};
+                case S::DCS_IGNORE:
+                        return {byteClass == C::ESCAPE ? S::DCS_ESCAPE : S::DCS_IGNORE, A::NONE};
+                case S::DCS_ESCAPE:
+                        return byteClass == C::BACKSLASH ? InputTransition{S::GROUND, A::DCS_DISPATCH} : InputTransition{S::ESCAPE, A::DCS_ABORT};
+                default:
+                        break;
+        }
+        if (byteClass == C::CONTROL || byteClass == C::ESCAPE || byteClass == C::HIGH) return {S::GROUND, A::ABORT};
+        if (byteClass == C::DELETE) return {state, A::NONE};
+        bool final = (byteClass == C::FINAL || byteClass == C::BRACKET || byteClass == C::LETTER_O || byteClass == C::LETTER_P
+                        || byteClass == C::BACKSLASH);
+        switch (state) {
+                case S::SS3:
+                        // Old xterms send a modifier parameter in SS3 sequences, as in ESC O 5 P for ctrl+F1.
+                        if (byteClass == C::DIGIT) return {S::SS3, A::PARAM_DIGIT};
+                        if (byteClass == C::SEMICOLON) return {S::SS3, A::PARAM_NEXT};
+                        return {S::GROUND, A::SS3_DISPATCH};
+                case S::CSI_ENTRY:
+                        if (byteClass == C::PRIVATE) return {S::CSI_PARAM, A::PRIVATE_MARKER};
+                        [[fallthrough]];
+                case S::CSI_PARAM:
+                        if (byteClass == C::DIGIT) return {S::CSI_PARAM, A::PARAM_DIGIT};
+                        [[fallthrough]];
+                case S::CSI_SUBPARAM:
+                        // Sub-parameters after a colon, such as the alternate keys of CSI u, are skipped.
+                        if (byteClass == C::DIGIT || byteClass == C::COLON) return {S::CSI_SUBPARAM, A::NONE};
+                        if (byteClass == C::SEMICOLON) return {S::CSI_PARAM, A::PARAM_NEXT};
+                        [[fallthrough]];
+                case S::CSI_INTERMEDIATE:
+                        if (byteClass == C::INTERMEDIATE) return {S::CSI_INTERMEDIATE, A::INTERMEDIATE};
+                        if (final) return {S::GROUND, A::CSI_DISPATCH};
+                        return {S::CSI_IGNORE, A::IGNORE_START};
+                case S::CSI_IGNORE:
+                        return final ? InputTransition{S::GROUND, A::IGNORE_END} : InputTransition{S::CSI_IGNORE, A::NONE};
+                default:
+                        return {S::GROUND, A::ABORT};
+        }
+}
+
+static const size_t ESCAPE_STATES = size_t(EscapeState::DCS_ESCAPE) + 1;
+
+struct InputTable {
+        uint8_t byteClasses[256];
+        InputTransition transitions[ESCAPE_STATES][size_t(ByteClass::COUNT)];
+};
+
+constexpr InputTable makeInputTable() {
+        InputTable table{};
+        for (unsigned int byte = 0; byte < 256; byte++) table.byteClasses[byte] = uint8_t(byteClass(byte));
+        for (size_t state = 0; state < ESCAPE_STATES; state++) {
+                for (size_t byteClass = 0; byteClass < size_t(ByteClass::COUNT); byteClass++) {
+                        table.transitions[state][byteClass] = inputTransition(EscapeState(state), ByteClass(byteClass));
+                }
+        }
+        return table;
+}
+
+constexpr InputTable INPUT_TABLE = makeInputTable();
+
+/** The modifiers of an xterm modifier parameter, which is 1 plus bits for shift, alt, ctrl and meta. */
+uint8_t xtermModifiers(uint32_t param) {
+        if (param < 2) return 0;
+        uint32_t bits = param - 1;
+        return uint8_t(((bits & 1) << int(ModifierKey::SHIFT)) | (((bits >> 1) & 1) << int(ModifierKey::ALT))
+                        | (((bits >> 2) & 1) << int(ModifierKey::CTRL)) | (((bits >> 3) & 1) << int(ModifierKey::META)));
+}
+
+/** The key of a CSI or SS3 sequence with the final byte, as in CSI 1;5A or ESC O P. */
+bool letterKey(uint8_t final, Key& key) {
+        switch (final) {
+                case 'A': key = Key::UP; return true;
+                case 'B': key = Key::DOWN; return true;
+                case 'C': key = Key::RIGHT; return true;
+                case 'D': key = Key::LEFT; return true;
+                case 'E': key = Key::BEGIN; return true;
+                case 'F': key = Key::END; return true;
+                case 'H': key = Key::HOME; return true;
+                case 'P': key = Key::F1; return true;
+                case 'Q': key = Key::F2; return true;
+                case 'R': key = Key::F3; return true;
+                case 'S': key = Key::F4; return true;
+                default: return false;
+        }
+}
+
+/** The key of a CSI n ~ sequence, in both the vt220 and the rxvt numbering of home and end. */
+bool tildeKey(uint32_t number, Key& key) {
+        switch (number) {
+                case 1: case 7: key = Key::HOME; return true;
+                case 2: key = Key::INSERT; return true;
+                case 3: key = Key::DELETE; return true;
+                case 4: case 8: key = Key::END; return true;
+                case 5: key = Key::PAGE_UP; return true;
+                case 6: key = Key::PAGE_DOWN; return true;
+                case 11: key = Key::F1; return true;
+                case 12: key = Key::F2; return true;
+                case 13: key = Key::F3; return true;
+                case 14: key = Key::F4; return true;
+                case 15: key = Key::F5; return true;
+                case 17: key = Key::F6; return true;
+                case 18: key = Key::F7; return true;
+                case 19: key = Key::F8; return true;
+                case 20: key = Key::F9; return true;
+                case 21: key = Key::F10; return true;
+                case 23: key = Key::F11; return true;
+                case 24: key = Key::F12; return true;
+                default: return false;
+        }
+}
+
+}
+
+bool Terminal::processByte(uint8_t byte) {
+        if (mUtf8Index > 0) return processUtf8(byte);
+        InputTransition transition = INPUT_TABLE.transitions[size_t(mEscapeState)][INPUT_TABLE.byteClasses[byte]];
+        mEscapeState = transition.state;
+        switch (transition.action) {
+                case InputAction::NONE:
+                        break;
+                case InputAction::ALT_CHARACTER:
+                        mEscapeModifiers |= 1 << int(ModifierKey::ALT);
+                        [[fallthrough]];
+                case InputAction::CHARACTER:
+                        characterEvent(byte);
+                        break;
+                case InputAction::ALT_UTF8:
+                        mEscapeModifiers |= 1 << int(ModifierKey::ALT);
+                        [[fallthrough]];
+                case InputAction::UTF8:
+                        return processUtf8(byte);
+                case InputAction::ALT_ESCAPE:
+                        mEscapeModifiers |= 1 << int(ModifierKey::ALT);
+                        break;
+                case InputAction::SEQUENCE_START:
+                        mEscapeParamCount = 0;
+                        mEscapeParams[0] = 0;
+                        mEscapePrivate = 0;
+                        mEscapeIntermediate = 0;
+                        break;
+                case InputAction::PRIVATE_MARKER:
+                        mEscapePrivate = byte;
+                        break;
+                case InputAction::PARAM_DIGIT: {
+                        if (mEscapeParamCount == 0) mEscapeParamCount = 1;
+                        uint32_t& param = mEscapeParams[mEscapeParamCount - 1];
+                        param = param * 10 + (byte - '0');
+                        if (param > MAX_ESCAPE_PARAM_VALUE) {
+                                mIgnoredError = ParseError::ARGUMENT_TOO_LONG;
+                                mEscapeState = EscapeState::CSI_IGNORE;
+                        }
+                        break;
+                }
+                case InputAction::PARAM_NEXT:
+                        if (mEscapeParamCount == 0) mEscapeParamCount = 1;
+                        if (mEscapeParamCount == MAX_ESCAPE_PARAMS) {
+                                mIgnoredError = ParseError::TOO_MANY_ARGUMENTS;
+                                mEscapeState = EscapeState::CSI_IGNORE;
                         } else {
-                                if (mUtf8Remaining > 0) {
-                                        if ((byte & 0b11000000) != 0b10000000) {
-                                                // Not a UTF-8 continuation byte so replace the entire sequence up to now with the replacement char:
-                                                mLastCharacter = 0xFFFD;
-                                                mLastEventType = EventType::CHAR;
-                                        } else {
-                                                mUtf8Buffer[mUtf8Index++] = byte;
-                                                if (--mUtf8Remaining == 0) {
-                                                        uint8_t firstByteMask = (uint8_t) (mUtf8Index == 2 ? 0b00011111 : (mUtf8Index == 3 ? 0b00001111 : 0b00000111));
-                                                        uint32_t codePoint = (mUtf8Buffer[0] & firstByteMask);
-                                                        for (unsigned int i = 1; i < mUtf8Index; i++)
-                                                                codePoint = ((codePoint << 6) | (mUtf8Buffer[i] & 0b00111111));
-                                                        if (((codePoint <= 0b1111111) && mUtf8Index > 1) || (codePoint < 0b11111111111 && mUtf8Index > 2)
-                                                                        || (codePoint < 0b1111111111111111 && mUtf8Index > 3)) {
-                                                                // Overlong encoding.
-                                                                codePoint = 0xFFFD;
-                                                        }
-
-                                                        mUtf8Index = mUtf8Remaining = 0;
-
-                                                        if (codePoint >= 0x80 && codePoint <= 0x9F) {
-                                                                // Sequence decoded to a C1 control character which is
-                                                                // the same as ESC followed by ((code & 0x7f) + 0x40).
-                                                                // processCodePoint(27);
-                                                                // FIXME
-                                                                // processCodePoint((codePoint & 0x7F) + 0x40);
-                                                        } else {
-                                                                //if (Character.UNASSIGNED == Character.getType(codePoint)) codePoint = UNICODE_REPLACEMENT_CHAR;
-                                                                mLastCharacter = 0xFFFD;
-                                                                mLastEventType = EventType::CHAR;
-                                                        }
-                                                }
-                                        }
-                                } else {
-                                        if ((byte & 0b10000000) == 0) { // The leading bit is not set so it is a 7-bit ASCII character.
-                                                mLastCharacter = byte;
-                                                mLastEventType = EventType::CHAR;
-                                        } else if ((byte & 0b11100000) == 0b11000000) { // 110xxxxx, a two-byte sequence.
-                                                mUtf8Remaining = 1;
-                                        } else if ((byte & 0b11110000) == 0b11100000) { // 1110xxxx, a three-byte sequence.
-                                                mUtf8Remaining = 2;
-                                        } else if ((byte & 0b11111000) == 0b11110000) { // 11110xxx, a four-byte sequence.
-                                                mUtf8Remaining = 3;
-                                        } 
-                                        mUtf8Buffer[mUtf8Index++] = byte;
-                                }
+                                mEscapeParams[mEscapeParamCount++] = 0;
                         }
                         break;
-                case EscapeState::ESCAPE:
-                        switch (byte) {
-                                case '[':
-                                        mEscapeState = EscapeState::CSI;
-                                        break;
-                                case 'O':
-                                        mEscapeState = EscapeState::ESCAPE_O;
-                                        break;
-                                default:
-                                        escapeError("invalid input in ESCAPE");
-                                        break;
+                case InputAction::INTERMEDIATE:
+                        mEscapeIntermediate = byte;
+                        break;
+                case InputAction::CSI_DISPATCH:
+                        dispatchCsi(byte);
+                        break;
+                case InputAction::SS3_DISPATCH:
+                        dispatchSs3(byte);
+                        break;
+                case InputAction::IGNORE_START:
+                        mIgnoredError = ParseError::UNKNOWN_ESCAPE;
+                        break;
+                case InputAction::IGNORE_END:
+                        escapeError(mIgnoredError);
+                        break;
+                case InputAction::ABORT:
+                        escapeError(ParseError::UNKNOWN_ESCAPE);
+                        return false;
+                case InputAction::DCS_START:
+                        // Only replies to a probe start with DCS, so otherwise this is alt+P.
+                        if (!mProbeRepliesPending) {
+                                mEscapeState = EscapeState::GROUND;
+                                mEscapeModifiers |= 1 << int(ModifierKey::ALT);
+                                characterEvent(byte);
                         }
+                        mDcsLength = 0;
                         break;
-                case EscapeState::CSI:
-                        switch (byte) {
-                                case 'A':
-                                case 'B':
-                                case 'C':
-                                case 'D':
-                                        mLastKey = Key(uint32_t(Key::UP) + (byte - 'A'));
-                                        mLastEventType = EventType::KEY;
-                                        escapeDone();
-                                        break;
-                                case '<':
-                                        mEscapeState = EscapeState::CSI_LOWERTHAN;
-                                        break;
-                                case '~':
-                                        if (mCurrentEscapeArg != 0) {
-                                                escapeError("Found ~ after CSI, but num args=%d", mCurrentEscapeArg);
-                                        } else {
-                                                switch (argAsNumber(0)) {
-                                                        case 15: mLastKey = Key::F5; break;
-                                                        case 17: mLastKey = Key::F6; break;
-                                                        case 18: mLastKey = Key::F7; break;
-                                                        case 19: mLastKey = Key::F8; break;
-                                                        case 20: mLastKey = Key::F9; break;
-                                                        case 21: mLastKey = Key::F10; break;
-                                                        case 23: mLastKey = Key::F11; break;
-                                                        case 24: mLastKey = Key::F12; break;
-                                                        default: escapeError("Unknown CSI ~ number"); return;
-                                                }
-                                                mLastEventType = EventType::KEY;
-                                                escapeDone();
-                                        }
-                                        break;
-                                default:
-                                        addEscapeArg(byte);
+                case InputAction::DCS_COLLECT:
+                        if (mDcsLength < MAX_DCS_KEPT) mDcs[mDcsLength] = char(byte);
+                        if (++mDcsLength == MAX_DCS_LENGTH) mEscapeState = EscapeState::DCS_IGNORE;
+                        break;
+                case InputAction::DCS_DISPATCH:
+                        dispatchDcs();
+                        break;
+                case InputAction::DCS_ABORT:
+                        // The ESC did not start ST, so drop the string and let it start a sequence.
+                        IF_STATS(mStats.parseErrors[size_t(ParseError::UNKNOWN_ESCAPE)]++);
+                        mEscapeModifiers = 0;
+                        return false;
+        }
+        return true;
+}
+
+bool Terminal::processUtf8(uint8_t byte) {
+        mUtf8Buffer[mUtf8Index++] = byte;
+        uint32_t codePoint;
+        int sequenceLength = decodeUtf8(mUtf8Buffer, mUtf8Index, codePoint);
+        if (sequenceLength == UTF8_INCOMPLETE) return true;
+        bool reprocess = false;
+        if (sequenceLength == UTF8_INVALID) {
+                // Replace the sequence up to now with the replacement character. A byte that was not a
+                // valid continuation may start something new, so process it again afterwards.
+                codePoint = 0xFFFD;
+                reprocess = (mUtf8Index > 1);
+                IF_STATS(mStats.parseErrors[size_t(ParseError::INVALID_UTF8)]++);
+        }
+        mUtf8Index = 0;
+        if (codePoint >= 0x80 && codePoint <= 0x9F) {
+                // Sequence decoded to a C1 control character which is
+                // the same as ESC followed by ((code & 0x7f) + 0x40).
+                processByte(27);
+                processByte((codePoint & 0x7F) + 0x40);
+        } else {
+                characterEvent(codePoint);
+        }
+        return !reprocess;
+}
+
+void Terminal::characterEvent(uint32_t character, uint32_t modifierParam) {
+        mEvent.type = EventType::CHAR;
+        mEvent.character = character;
+        mEvent.modifiers = mEscapeModifiers | xtermModifiers(modifierParam);
+        mEscapeModifiers = 0;
+}
+
+void Terminal::keyEvent(Key key, uint32_t modifierParam) {
+        mEvent.type = EventType::KEY;
+        mEvent.key = key;
+        mEvent.modifiers = mEscapeModifiers | xtermModifiers(modifierParam);
+        mEscapeModifiers = 0;
+}
+
+void Terminal::dispatchCsi(uint8_t final) {
+        if (mEscapePrivate == '<' && mEscapeIntermediate == 0 && (final == 'M' || final == 'm')) {
+                if (mEscapeParamCount != 3) {
+                        escapeError(ParseError::MOUSE_ARGUMENTS);
+                        return;
+                }
+                // The low two bits are the button, 3 meaning none, with flags for modifiers, motion and wheel.
+                uint32_t mouseButtonCode = mEscapeParams[0];
+                mEvent.column = mEscapeParams[1] - 1;
+                mEvent.row = flipRow(mEscapeParams[2]);
+                mEvent.mouseButton = uint8_t((mouseButtonCode & 3) + ((mouseButtonCode & 64) ? 4 : 0));
+                mEvent.modifiers = mEscapeModifiers;
+                mEscapeModifiers = 0;
+                if (mouseButtonCode & 4) mEvent.modifiers |= 1 << int(ModifierKey::SHIFT);
+                if (mouseButtonCode & 8) mEvent.modifiers |= 1 << int(ModifierKey::ALT);
+                if (mouseButtonCode & 16) mEvent.modifiers |= 1 << int(ModifierKey::CTRL);
+                if (mouseButtonCode & 32) {
+                        mEvent.type = ((mouseButtonCode & 3) == 3) ? EventType::MOUSE_MOVED : EventType::MOUSE_MOVED_PRESSED;
+                } else {
+                        mEvent.type = (final == 'M') ? EventType::MOUSE_DOWN : EventType::MOUSE_UP;
+                }
+                return;
+        }
+        if (dispatchProbeReply(final)) return;
+        if (mEscapePrivate != 0 || mEscapeIntermediate != 0) {
+                escapeError(ParseError::UNKNOWN_ESCAPE);
+                return;
+        }
+        Key key;
+        switch (final) {
+                case '~':
+                        // CSI 27 ; modifiers ; character ~ is a modified character with xterm's modifyOtherKeys.
+                        if (mEscapeParamCount == 3 && mEscapeParams[0] == 27) {
+                                characterEvent(mEscapeParams[2], mEscapeParams[1]);
+                        } else if (mEscapeParamCount > 2) {
+                                escapeError(ParseError::TILDE_ARGUMENTS);
+                        } else if (escapeParam(0) == 200) {
+                                mPasting = true;
+                        } else if (escapeParam(0) == 201) {
+                                // The end of a paste that was already delivered, as when it arrived in pieces.
+                        } else if (tildeKey(escapeParam(0), key)) {
+                                keyEvent(key, escapeParam(1));
+                        } else {
+                                escapeError(ParseError::UNKNOWN_TILDE_KEY);
                         }
                         break;
-                case EscapeState::CSI_LOWERTHAN:
-                        switch (byte) {
-                                case 'm':
-                                case 'M':
-                                        if (mCurrentEscapeArg != 2) {
-                                                escapeError("MOUSE: %d, %c", mCurrentEscapeArg, byte);
-                                        } else {
-                                                int mouseButtonCode = argAsNumber(0);
-                                                if (mouseButtonCode >= 32) {
-                                                } else {
-                                                        mLastMouseColumn = argAsNumber(1) - 1;
-                                                        mLastMouseRow = flipRow(argAsNumber(2));
-                                                        mLastEventType = (byte == 'M') ? EventType::MOUSE_DOWN : EventType::MOUSE_UP;
-                                                }
-                                                escapeDone();
-                                        }
-                                        break;
-                                default:
-                                        addEscapeArg(byte);
-                                        break;
+                case 'u':
+                        // CSI character ; modifiers u is a modified character with CSI u (fixterms or kitty) keyboard reporting.
+                        characterEvent(escapeParam(0), escapeParam(1));
+                        break;
+                case 'Z':
+                        keyEvent(Key::BACK_TAB, escapeParam(1));
+                        break;
+                case 'I':
+                case 'O':
+                        if (mEscapeParamCount == 0) {
+                                mEvent.type = (final == 'I') ? EventType::FOCUS_IN : EventType::FOCUS_OUT;
+                                mEscapeModifiers = 0;
+                        } else {
+                                escapeError(ParseError::UNKNOWN_ESCAPE);
                         }
                         break;
-                case EscapeState::ESCAPE_O:
-                        switch (byte) {
-                                case 'P': mLastKey = Key::F1; break;
-                                case 'Q': mLastKey = Key::F2; break;
-                                case 'R': mLastKey = Key::F3; break;
-                                case 'S': mLastKey = Key::F4; break;
-                                default: escapeError("ESCAPE_O followed by strange char"); return;
-                        }
-                        mLastEventType = EventType::KEY;
-                        escapeDone();
+                case 'R':
+                        // CSI row ; column R is a cursor position report, except that CSI 1 ; modifiers R is F3 with
+                        // modifiers, which is only taken to be a report while one has been asked for.
+                        if (mEscapeParamCount == 2 && (mEscapeParams[0] != 1 || mCursorPositionRequests > 0)) {
+                                if (mCursorPositionRequests > 0) mCursorPositionRequests--;
+                                mEvent.type = EventType::CURSOR_POSITION;
+                                mEvent.row = flipRow(mEscapeParams[0]);
+                                mEvent.column = mEscapeParams[1] - 1;
+                                mEscapeModifiers = 0;
+                        } else if (mEscapeParamCount <= 2) {
+                                keyEvent(Key::F3, escapeParam(1));
+                        } else {
+                                escapeError(ParseError::UNKNOWN_ESCAPE);
+                        }
                         break;
+                default:
+                        // CSI 1 ; modifiers A and the like for modified keys, and CSI A without them.
+                        if (letterKey(final, key) && mEscapeParamCount <= 2) {
+                                keyEvent(key, escapeParam(1));
+                        } else {
+                                escapeError(ParseError::UNKNOWN_ESCAPE);
+                        }
+                        break;
+        }
+}
+
+void Terminal::dispatchSs3(uint8_t final) {
+        Key key;
+        uint32_t modifierParam = escapeParam(mEscapeParamCount > 0 ? mEscapeParamCount - 1 : 0);
+        if (letterKey(final, key)) {
+                keyEvent(key, modifierParam);
+        } else if (final >= 'j' && final <= 'y') {
+                // The application keypad sends *+,-./ and the digits as ESC O j to ESC O y.
+                characterEvent(final - 0x40, modifierParam);
+        } else if (final == 'M' || final == 'I' || final == 'X' || final == ' ') {
+                // Enter, tab, = and space on the application keypad.
+                characterEvent(final == 'M' ? '\r' : (final == 'I' ? '\t' : (final == 'X' ? '=' : ' ')), modifierParam);
+        } else {
+                escapeError(ParseError::UNKNOWN_SS3);
+        }
+}
+
+bool Terminal::dispatchProbeReply(uint8_t final) {
+        if (mEscapePrivate == '?' && mEscapeIntermediate == 0 && final == 'c') {
+                // DA1, CSI ? class ; extensions c, where 28 is rectangular editing.
+                bool rectangular = false;
+                for (unsigned int i = 1; i < mEscapeParamCount; i++) rectangular |= (mEscapeParams[i] == 28);
+                if (rectangular) mConfirmedCapabilities |= 1u << int(Capability::RECTANGULAR_EDITING);
+                if (mProbeRepliesPending) finishProbe(true);
+        } else if (mEscapePrivate == '>' && mEscapeIntermediate == 0 && final == 'c') {
+                // DA2, CSI > type ; version ; cartridge c, which only tells what XTVERSION tells better.
+        } else if (mEscapePrivate == '?' && mEscapeIntermediate == '$' && final == 'y') {
+                // DECRQM, CSI ? mode ; status $ y, where a status of 1 to 4 is set or reset, and 0 is not recognized.
+                uint32_t status = escapeParam(1);
+                if (status >= 1 && status <= 4) {
+                        switch (escapeParam(0)) {
+                                case 2026: mConfirmedCapabilities |= 1u << int(Capability::SYNCHRONIZED_UPDATES); break;
+                                case 2004: mConfirmedCapabilities |= 1u << int(Capability::BRACKETED_PASTE); break;
+                                case 1006: mConfirmedCapabilities |= 1u << int(Capability::SGR_MOUSE); break;
+                                default: break;
+                        }
+                }
+        } else {
+                return false;
+        }
+        mEscapeModifiers = 0;
+        return true;
+}
+
+void Terminal::dispatchDcs() {
+        // XTVERSION, DCS > | name and version ST.
+        unsigned int kept = mDcsLength < MAX_DCS_KEPT ? mDcsLength : MAX_DCS_KEPT;
+        if (mDcsLength == MAX_DCS_LENGTH) {
+                IF_STATS(mStats.parseErrors[size_t(ParseError::ARGUMENT_TOO_LONG)]++);
+        } else if (kept >= 2 && mDcs[0] == '>' && mDcs[1] == '|') {
+                mTerminalVersion.assign(mDcs + 2, kept - 2);
+        } else {
+                IF_STATS(mStats.parseErrors[size_t(ParseError::UNKNOWN_ESCAPE)]++);
+        }
+        mEscapeModifiers = 0;
+}
+
+/** If the terminal is one that is known from its XTVERSION reply to support REP and 24-bit colors, which no query tells. */
+static bool knownModernTerminal(std::string const& version) {
+        static char const* const NAMES[] = {"xterm(", "kitty(", "foot(", "WezTerm ", "tmux ", "contour ", "ghostty "};
+        for (char const* name : NAMES) {
+                if (version.compare(0, strlen(name), name) == 0) return true;
         }
+        return false;
+}
+
+Terminal& Terminal::probeCapabilities(unsigned int timeoutMilliseconds, bool useCache) {
+        mProbeCacheKey = useCache ? CapabilityCache::terminalKey(mIo) : std::string();
+        CapabilityCache::Entry entry;
+        if (!mProbeCacheKey.empty() && CapabilityCache().load(mProbeCacheKey, entry)) {
+                mCapabilities = (mCapabilities & ~PROBED_CAPABILITIES) | (entry.capabilities & PROBED_CAPABILITIES);
+                mTerminalVersion = entry.version;
+                mCapabilitiesProbed = true;
+                mProbeEventPending = true;
+                return *this;
+        }
+        mConfirmedCapabilities = 0;
+        mProbeRepliesPending = true;
+        mProbeDeadline = monotonicNanos() + uint64_t(timeoutMilliseconds) * 1000000;
+        // XTVERSION, DA2 and DECRQM for the modes of interest, which not all terminals reply to, and last DA1, which all do
+        // and which is replied to after the others, so that its reply tells that no more are coming.
+        emit<Csi::XTVERSION>(0).emit<Csi::DA2>().emit<Csi::DECRQM>(2026).emit<Csi::DECRQM>(2004).emit<Csi::DECRQM>(1006).emit<Csi::DA1>();
+        flush();
+        return *this;
+}
+
+void Terminal::finishProbe(bool answered) {
+        uint32_t found = mConfirmedCapabilities;
+        if (knownModernTerminal(mTerminalVersion)) found |= (1u << int(Capability::REPEAT)) | (1u << int(Capability::TRUE_COLOR));
+        if (answered) {
+                // What was not confirmed is missing, except for 24-bit colors that the environment told about.
+                found |= mCapabilities & (1u << int(Capability::TRUE_COLOR));
+                mCapabilities = (mCapabilities & ~PROBED_CAPABILITIES) | found;
+                mProbeRepliesPending = false;
+                if (!mProbeCacheKey.empty()) CapabilityCache().store(mProbeCacheKey, CapabilityCache::Entry{mCapabilities & PROBED_CAPABILITIES, mTerminalVersion});
+        } else {
+                // Without all replies, only add what was confirmed. Should the replies come after all, this is done again.
+                mCapabilities |= found;
+        }
+        mProbeDeadline = 0;
+        mCapabilitiesProbed = true;
+        mEvent.type = EventType::CAPABILITIES;
+}
+
+void Terminal::escapeTimedOut() {
+        // A lone ESC is the escape key, while ESC [, ESC O and ESC P without more are those characters with alt.
+        uint32_t character = 27;
+        if (mEscapeState == EscapeState::CSI_ENTRY) character = '[';
+        else if (mEscapeState == EscapeState::SS3) character = 'O';
+        else if (mEscapeState == EscapeState::DCS_STRING) character = 'P';
+        if (mEscapeState != EscapeState::ESCAPE) mEscapeModifiers |= 1 << int(ModifierKey::ALT);
+        mEscapeState = EscapeState::GROUND;
+        mEscapeDeadline = 0;
+        characterEvent(character);
 }
 
 Terminal& Terminal::print(char const* fmt, ...) {
         va_list argp;
         va_start(argp, fmt);
-        vfprintf(stdout, fmt, argp);
+        if (mRetained) {
+                printFormatted(false, 0, fmt, argp);
+        } else {
+                presentStyle(mStyle);
+                mOutput.appendFormatted(fmt, argp);
+                outputWritten();
+        }
+        va_end(argp);
+        return *this;
+}
+
+Terminal& Terminal::printClipped(unsigned int maxWidth, char const* fmt, ...) {
+        va_list argp;
+        va_start(argp, fmt);
+        printFormatted(true, maxWidth, fmt, argp);
         va_end(argp);
-        fflush(stdout);
         return *this;
 }
 
+void Terminal::printFormatted(bool clip, unsigned int maxWidth, char const* fmt, va_list argp) {
+        char stackBuffer[512];
+        char* heapBuffer = nullptr;
+        char* text = stackBuffer;
+        va_list argpCopy;
+        va_copy(argpCopy, argp);
+        int formattedLength = vsnprintf(stackBuffer, sizeof(stackBuffer), fmt, argp);
+        if (formattedLength >= int(sizeof(stackBuffer))) {
+                heapBuffer = (char*) malloc(formattedLength + 1);
+                vsnprintf(heapBuffer, formattedLength + 1, fmt, argpCopy);
+                text = heapBuffer;
+        }
+        va_end(argpCopy);
+        size_t length = formattedLength > 0 ? formattedLength : 0;
+        if (clip) {
+                // The cursor is only known in retained mode, where the text should not wrap.
+                if (mRetained) maxWidth = std::min(maxWidth, mWrapPending ? 0 : mColumns - mCursorColumn);
+                size_t width;
+                length = clipToWidth(text, length, maxWidth, width);
+        }
+        if (length > 0) {
+                if (mRetained) {
+                        putText(text, length);
+                } else {
+                        presentStyle(mStyle);
+                        mOutput.append(text, length);
+                        outputWritten();
+                }
+        }
+        free(heapBuffer);
+}
+
 Terminal& Terminal::setTitle(char const* fmt, ...) { 
-        print("\033]0;");
+        mOutput.append("\033]0;", 4);
         va_list argp;
         va_start(argp, fmt);
-        vfprintf(stdout, fmt, argp);
+        mOutput.appendFormatted(fmt, argp);
         va_end(argp);
-        fflush(stdout);
-        print("\007");
+        mOutput.append('\007');
+        outputWritten();
         return *this;
 }
+
+Terminal& Terminal::flush() {
+        if (mOutput.size() > 0) {
+                size_t written;
+                unsigned int writeCalls = mIo.write(mOutput.data(), mOutput.size(), written);
+                IF_STATS(mStats.flushes++);
+                IF_STATS(mStats.bytesWritten += written);
+                IF_STATS(mStats.writeCalls += writeCalls);
+                (void) writeCalls;
+        }
+        mOutput.clear();
+        return *this;
+}
+
+Terminal& Terminal::clear() {
+        if (mRetained) {
+                mBackBuffer.fill(blankCell());
+                damage(0, 0, mRows, mColumns);
+                if (!mFrontBufferKnown && mCanvas == nullptr) mClearPending = true;
+        } else {
+                presentStyle(mStyle);
+                emit<Csi::ED>(2); /* ED – Erase In Display */
+        }
+        return *this;
+}
+
+Terminal& Terminal::placeCursor(unsigned int x, unsigned int y) {
+        if (mRetained) {
+                mCursorRow = (y >= mRows) ? 0 : flipRow(y) - 1;
+                mCursorColumn = (x >= mColumns) ? mColumns - 1 : x;
+                mWrapPending = false;
+        } else {
+                emit<Csi::CUP>(flipRow(y), x + 1);
+        }
+        return *this;
+}
+
+Terminal& Terminal::placeCursorAtColumn(unsigned int x) {
+        if (mRetained) {
+                mCursorColumn = (x >= mColumns) ? mColumns - 1 : x;
+                mWrapPending = false;
+        } else {
+                emit<Csi::CHA>(x + 1);
+        }
+        return *this;
+}
+
+Terminal& Terminal::erase(unsigned int chars) {
+        if (mRetained) {
+                unsigned int right = (chars >= mColumns - mCursorColumn) ? mColumns : mCursorColumn + chars;
+                mBackBuffer.fillRectangle(mCursorRow, mCursorColumn, mCursorRow + 1, right, blankCell());
+                damage(mCursorRow, mCursorColumn, mCursorRow + 1, right);
+        } else {
+                presentStyle(mStyle);
+                emit<Csi::ECH>(chars);
+        }
+        return *this;
+}
+
+Terminal& Terminal::insertLines(unsigned int lines) {
+        if (mRetained) {
+                // IL only has effect inside the scrolling region, and moves the cursor to the first column.
+                if (mCursorRow >= mMarginTop && mCursorRow < mMarginBottom) {
+                        mBackBuffer.scrollDown(mCursorRow, mMarginBottom, lines, blankCell());
+                        damage(mCursorRow, 0, mMarginBottom, mColumns);
+                        mCursorColumn = 0;
+                        mWrapPending = false;
+                }
+        } else {
+                presentStyle(mStyle);
+                emit<Csi::IL>(lines);
+        }
+        return *this;
+}
+
+Terminal& Terminal::deleteLines(unsigned int lines) {
+        if (mRetained) {
+                if (mCursorRow >= mMarginTop && mCursorRow < mMarginBottom) {
+                        mBackBuffer.scrollUp(mCursorRow, mMarginBottom, lines, blankCell());
+                        damage(mCursorRow, 0, mMarginBottom, mColumns);
+                        mCursorColumn = 0;
+                        mWrapPending = false;
+                }
+        } else {
+                presentStyle(mStyle);
+                emit<Csi::DL>(lines);
+        }
+        return *this;
+}
+
+Terminal& Terminal::deleteCells(unsigned int cells) {
+        if (mRetained) {
+                if (mRows == 0 || mColumns == 0) return *this;
+                Cell* row = mBackBuffer.row(mCursorRow);
+                unsigned int remaining = mColumns - mCursorColumn;
+                if (cells > remaining) cells = remaining;
+                memmove(row + mCursorColumn, row + mCursorColumn + cells, (remaining - cells) * sizeof(Cell));
+                for (unsigned int column = mColumns - cells; column < mColumns; column++) row[column] = blankCell();
+                damage(mCursorRow, mCursorColumn, mCursorRow + 1, mColumns);
+                mWrapPending = false;
+        } else {
+                presentStyle(mStyle);
+                emit<Csi::DCH>(cells);
+        }
+        return *this;
+}
+
+Terminal& Terminal::setMargins(unsigned int top, unsigned int bottom) {
+        if (mRetained) {
+                // Like DECSTBM: 1-based and inclusive, where 0 means the default. Moves the cursor home.
+                if (top == 0) top = 1;
+                if (bottom == 0 || bottom > mRows) bottom = mRows;
+                if (top >= bottom) return *this;
+                mMarginTop = top - 1;
+                mMarginBottom = bottom;
+                mCursorRow = mCursorColumn = 0;
+                mWrapPending = false;
+        } else {
+                emit<Csi::DECSTBM>(top, bottom);
+        }
+        return *this;
+}
+
+Terminal& Terminal::setRetainedMode(bool retained) {
+        if (retained == mRetained) return *this;
+        if (retained) {
+                mRetained = true;
+                resetScreenModel(false);
+        } else {
+                present();
+                mRetained = false;
+        }
+        return *this;
+}
+
+void Terminal::resetScreenModel(bool screenBlank) {
+        drawOn(nullptr);
+        // Switching screens saves and restores the cursor together with its attributes, so make sure they are set explicitly.
+        emit<Csi::SGR>();
+        mPresentedStyle = Style();
+        if (!mRetained) return;
+        mFrontBuffer.resize(size());
+        mBackBuffer.resize(size());
+        mFrontBuffer.fill(Cell());
+        mBackBuffer.fill(Cell());
+        if (!mCanvases.empty()) {
+                mComposedBuffer.resize(size());
+                mScreenDamage.reset(mRows);
+                mScreenDamage.add(0, 0, mRows, mColumns);
+        }
+        mClearPending = false;
+        mFrontBufferKnown = screenBlank;
+        mCursorRow = mCursorColumn = 0;
+        mWrapPending = false;
+        mMarginTop = 0;
+        mMarginBottom = mRows;
+        mPresentedRow = mPresentedColumn = UINT32_MAX;
+        mCopyHints.clear();
+}
+
+Terminal& Terminal::repaint() {
+        if (!mRetained) return *this;
+        // The clear resets the style, but not the cursor.
+        mClearPending = true;
+        mPresentedRow = mPresentedColumn = UINT32_MAX;
+        mCopyHints.clear();
+        return *this;
+}
+
+Terminal& Terminal::forgetCursorAndStyle() {
+        emit<Csi::SGR>();
+        mPresentedStyle = Style();
+        mPresentedRow = mPresentedColumn = UINT32_MAX;
+        return *this;
+}
+
+void Terminal::resizeScreenModel() {
+        if (!mRetained) return;
+        mFrontBuffer.resize(size());
+        mBackBuffer.resize(size());
+        if (!mCanvases.empty()) {
+                mComposedBuffer.resize(size());
+                mScreenDamage.reset(mRows);
+                mScreenDamage.add(0, 0, mRows, mColumns);
+        }
+        // How the terminal has rearranged its content on resize is unknown, so repaint everything.
+        mClearPending = true;
+        if (mCursorRow >= mRows) mCursorRow = mRows - 1;
+        if (mCursorColumn >= mColumns) mCursorColumn = mColumns - 1;
+        mWrapPending = false;
+        mMarginTop = 0;
+        mMarginBottom = mRows;
+        mPresentedRow = mPresentedColumn = UINT32_MAX;
+        mCopyHints.clear();
+}
+
+void Terminal::putText(char const* text, size_t length) {
+        uint8_t const* bytes = (uint8_t const*) text;
+        size_t i = 0;
+        while (i < length) {
+                // Printable ASCII characters are clusters by themselves, except the last one before non-ASCII that may be followed by combining marks.
+                size_t ascii = scanPrintableAscii(bytes + i, length - i);
+                if (ascii > 0 && i + ascii < length && bytes[i + ascii] >= 0x80) ascii--;
+                if (ascii > 0) {
+                        uint32_t style = styleIndex();
+                        for (size_t end = i + ascii; i < end; i++) putCharacter(Cell(bytes[i], style));
+                        if (i == length) break;
+                }
+
+                uint32_t codepoint;
+                int sequenceLength = decodeUtf8(bytes + i, length - i, codepoint);
+                if (sequenceLength <= 0) {
+                        codepoint = 0xFFFD;
+                        sequenceLength = 1;
+                }
+                if (codepoint < 32 || codepoint == 0x7F) {
+                        // Controls are not part of clusters, and CR LF has to be handled as two characters.
+                        putControl(codepoint);
+                        i += sequenceLength;
+                        continue;
+                }
+                unsigned int width;
+                size_t clusterLength = nextGrapheme(bytes + i, length - i, width);
+                // Zero width clusters, such as a combining mark at the start of the text, are dropped.
+                if (width > 0 && mRows > 0 && mColumns >= width) {
+                        uint32_t handle = (clusterLength > size_t(sequenceLength)) ? mGraphemes.intern(bytes + i, clusterLength) : UINT32_MAX;
+                        // If the pool is full only the first code point is kept.
+                        putCharacter(handle == UINT32_MAX ? Cell(codepoint, styleIndex(), width) : Cell::grapheme(handle, styleIndex(), width));
+                }
+                i += clusterLength;
+        }
+}
+
+void Terminal::putCharacter(Cell const& cell) {
+        unsigned int width = cell.width();
+        if (mRows == 0 || mColumns < width) return;
+        if (mWrapPending) {
+                lineFeed();
+                mCursorColumn = 0;
+        }
+        if (mCursorColumn + width > mColumns) {
+                // A wide character that does not fit in the last column goes on the next line as a whole.
+                if (!mWrapAround) return;
+                lineFeed();
+                mCursorColumn = 0;
+        }
+        // Overwriting half of a wide character breaks it, which present() takes care of.
+        Cell* cells = mBackBuffer.row(mCursorRow) + mCursorColumn;
+        cells[0] = cell;
+        if (width == 2) cells[1] = Cell(Cell::WIDE_CONTINUATION, cell.style(), 0);
+        damage(mCursorRow, mCursorColumn, mCursorRow + 1, mCursorColumn + width);
+        if (mCursorColumn + width < mColumns) {
+                mCursorColumn += width;
+        } else {
+                mCursorColumn = mColumns - 1;
+                mWrapPending = mWrapAround;
+                return;
+        }
+        mWrapPending = false;
+}
+
+void Terminal::putControl(uint32_t codepoint) {
+        switch (codepoint) {
+                case '\n':
+                        // Output post-processing is left on, so a newline is also a carriage return.
+                        lineFeed();
+                        mCursorColumn = 0;
+                        break;
+                case '\r':
+                        mCursorColumn = 0;
+                        break;
+                case '\b':
+                        if (mCursorColumn > 0) mCursorColumn--;
+                        break;
+                case '\t':
+                        mCursorColumn = (mCursorColumn + 8) & ~7u;
+                        if (mCursorColumn >= mColumns) mCursorColumn = mColumns - 1;
+                        break;
+                default:
+                        // Other control characters are ignored.
+                        return;
+        }
+        mWrapPending = false;
+}
+
+void Terminal::lineFeed() {
+        if (mCursorRow + 1 == mMarginBottom) {
+                mBackBuffer.scrollUp(mMarginTop, mMarginBottom, 1, blankCell());
+                damage(mMarginTop, 0, mMarginBottom, mColumns);
+        } else if (mCursorRow + 1 < mRows) {
+                mCursorRow++;
+        }
+}
+
+Terminal& Terminal::present() {
+        drawOn(nullptr);
+        mLastPresentChanged = false;
+        if (!mRetained) return *this;
+        IF_STATS(uint64_t presentStart = monotonicNanos());
+        beginFrame();
+        // Present the composited screen, while the back buffer keeps what is drawn on the screen itself. Since the last
+        // present() left the screen showing all of it, only the rows composited again can have changed.
+        bool compositing = !mCanvases.empty();
+        unsigned int changedTop = 0, changedBottom = mRows;
+        if (compositing) {
+                composite(changedTop, changedBottom);
+                if (mClearPending) {
+                        changedTop = 0;
+                        changedBottom = mRows;
+                }
+                std::swap(mBackBuffer, mComposedBuffer);
+        }
+        size_t outputBefore = mOutput.size();
+        bool synchronized = mSynchronizedUpdates && hasCapability(Capability::SYNCHRONIZED_UPDATES);
+        if (synchronized) decPrivateMode(2026, true);
+        size_t outputStart = mOutput.size();
+        if (mClearPending) {
+                emit<Csi::SGR>().emit<Csi::ED>(2);
+                mPresentedStyle = Style();
+                mFrontBuffer.fill(Cell());
+                mClearPending = false;
+        }
+        mFrontBufferKnown = true;
+        for (unsigned int row = changedTop; row < changedBottom; row++) mBackBuffer.removeBrokenWideCharacters(row);
+        presentCopies();
+        presentScrolls(changedTop, changedBottom);
+        // Rows from here to the bottom are blank, so that they can be erased together with the end of a row above.
+        unsigned int blankRowsFrom = mRows;
+        while (blankRowsFrom > 0) {
+                Cell const* back = mBackBuffer.row(blankRowsFrom - 1);
+                if (!std::all_of(back, back + mColumns, [](Cell const& cell) { return cell == Cell(); })) break;
+                blankRowsFrom--;
+        }
+        for (unsigned int row = changedTop; row < changedBottom; row++) presentRow(row, blankRowsFrom);
+        if (!cursor_hidden) moveRealCursor(mCursorRow, mCursorColumn);
+        mLastPresentChanged = (mOutput.size() != outputStart);
+        if (!mLastPresentChanged) {
+                mOutput.truncate(outputBefore);
+        } else if (synchronized) {
+                decPrivateMode(2026, false);
+        }
+        if (compositing) std::swap(mBackBuffer, mComposedBuffer);
+        if (mStyles.size() > 2 * mLiveStyles + 256 || mGraphemes.size() > 2 * mLiveGraphemes + 256) compactPools();
+#if SCREENCANVAS_STATS
+        mStats.presents++;
+        if (mLastPresentChanged) {
+                uint64_t now = monotonicNanos();
+                mStats.changedPresents++;
+                mStats.frameEncode.record(now - presentStart);
+                if (mUnpresentedInputTime != 0) mStats.inputToPresent.record(now - mUnpresentedInputTime);
+                mUnpresentedInputTime = 0;
+        }
+#endif
+        endFrame();
+        return *this;
+}
+
+void Terminal::compactPools() {
+        // Mark what the screen buffers and canvases refer to, which is all that is in use.
+        mStyleRemap.assign(mStyles.size(), UINT32_MAX);
+        mGraphemeRemap.assign(mGraphemes.size(), UINT32_MAX);
+        auto forEachBuffer = [this](auto function) {
+                function(mFrontBuffer);
+                function(mBackBuffer);
+                if (mCanvases.empty()) return;
+                function(mComposedBuffer);
+                for (Canvas* canvas : mCanvases) function(canvas->mBuffer);
+        };
+        forEachBuffer([this](ScreenBuffer const& buffer) {
+                for (unsigned int row = 0; row < buffer.rows(); row++) {
+                        Cell const* cells = buffer.row(row);
+                        for (unsigned int column = 0; column < buffer.columns(); column++) {
+                                mStyleRemap[cells[column].style()] = 0;
+                                if (cells[column].isGrapheme()) mGraphemeRemap[cells[column].graphemeHandle()] = 0;
+                        }
+                }
+        });
+        mStyles.compact(mStyleRemap);
+        mGraphemes.compact(mGraphemeRemap);
+        forEachBuffer([this](ScreenBuffer& buffer) {
+                for (unsigned int row = 0; row < buffer.rows(); row++) {
+                        Cell* cells = buffer.row(row);
+                        for (unsigned int column = 0; column < buffer.columns(); column++) cells[column] = cells[column].remapped(mStyleRemap, mGraphemeRemap);
+                }
+        });
+        mStyleIndex = UINT32_MAX;
+        mLiveStyles = mStyles.size();
+        mLiveGraphemes = mGraphemes.size();
+}
+
+Terminal& Terminal::drawOn(Canvas* canvas) {
+        if (!mRetained) canvas = nullptr;
+        if (canvas == mCanvas) return *this;
+        if (mCanvas != nullptr) swapDrawTarget(*mCanvas);
+        mCanvas = canvas;
+        if (mCanvas != nullptr) {
+                swapDrawTarget(*mCanvas);
+                mDamage = &mCanvas->mDamage;
+        }
+        updateDamageTarget();
+        return *this;
+}
+
+Size Terminal::screenSize() const {
+        return mCanvas == nullptr ? size() : Size{mCanvas->mState.rows, mCanvas->mState.columns};
+}
+
+void Terminal::swapDrawTarget(Canvas& canvas) {
+        Canvas::DrawState& state = canvas.mState;
+        std::swap(mBackBuffer, canvas.mBuffer);
+        std::swap(mRows, state.rows);
+        std::swap(mColumns, state.columns);
+        std::swap(mCursorRow, state.cursorRow);
+        std::swap(mCursorColumn, state.cursorColumn);
+        std::swap(mMarginTop, state.marginTop);
+        std::swap(mMarginBottom, state.marginBottom);
+        std::swap(mWrapPending, state.wrapPending);
+}
+
+void Terminal::addCanvas(Canvas* canvas) {
+        if (mCanvases.empty()) {
+                // Start compositing, from scratch since nothing has been damaged without canvases.
+                Size screen = screenSize();
+                mComposedBuffer.resize(screen);
+                mScreenDamage.reset(screen.rows);
+                mScreenDamage.add(0, 0, screen.rows, screen.columns);
+        }
+        canvas->mSequence = mCanvasSequence++;
+        mCanvases.push_back(canvas);
+        sortCanvases();
+        updateDamageTarget();
+        damageCanvas(*canvas, 0, 0, canvas->rows(), canvas->columns());
+}
+
+void Terminal::removeCanvas(Canvas* canvas) {
+        if (mCanvas == canvas) drawOn(nullptr);
+        damageCanvas(*canvas, 0, 0, canvas->rows(), canvas->columns());
+        mCanvases.erase(std::find(mCanvases.begin(), mCanvases.end(), canvas));
+        // Without canvases the back buffer is presented as it is.
+        updateDamageTarget();
+}
+
+void Terminal::sortCanvases() {
+        std::sort(mCanvases.begin(), mCanvases.end(), [](Canvas const* a, Canvas const* b) {
+                return a->mZ != b->mZ ? a->mZ < b->mZ : a->mSequence < b->mSequence;
+        });
+}
+
+void Terminal::damageCanvas(Canvas const& canvas, unsigned int top, unsigned int left, unsigned int bottom, unsigned int right) {
+        Size screen = screenSize();
+        Canvas::Area clip = canvas.clipArea();
+        int64_t originTop = canvas.screenTop(screen.rows), originLeft = canvas.mColumn;
+        int64_t screenTop = std::max({int64_t(0), originTop + std::max(int64_t(top), clip.top)});
+        int64_t screenBottom = std::min({int64_t(screen.rows), originTop + std::min(int64_t(bottom), clip.bottom)});
+        int64_t screenLeft = std::max({int64_t(0), originLeft + std::max(int64_t(left), clip.left)});
+        int64_t screenRight = std::min({int64_t(screen.columns), originLeft + std::min(int64_t(right), clip.right)});
+        if (screenTop >= screenBottom || screenLeft >= screenRight) return;
+        mScreenDamage.add(unsigned(screenTop), unsigned(screenLeft), unsigned(screenBottom), unsigned(screenRight));
+}
+
+void Terminal::hintCanvasMove(Canvas const& canvas, int64_t top, int64_t left) {
+        if (!canvas.mVisible || mCopyHints.size() >= MAX_COPY_HINTS) return;
+        // The part of the canvas that is shown both before and after the move.
+        Size screen = screenSize();
+        Canvas::Area clip = canvas.clipArea();
+        int64_t toTop = canvas.screenTop(screen.rows), toLeft = canvas.mColumn;
+        int64_t first = std::max({clip.top, -top, -toTop}), end = std::min({clip.bottom, screen.rows - top, screen.rows - toTop});
+        int64_t firstColumn = std::max({clip.left, -left, -toLeft}), endColumn = std::min({clip.right, screen.columns - left, screen.columns - toLeft});
+        if (first >= end || firstColumn >= endColumn) return;
+        mCopyHints.push_back(CopyHint{unsigned(top + first), unsigned(left + firstColumn), unsigned(top + end), unsigned(left + endColumn),
+                                      unsigned(toTop + first), unsigned(toLeft + firstColumn)});
+}
+
+void Terminal::composite(unsigned int& top, unsigned int& bottom) {
+        // Damage the screen where the shown canvases have been drawn on.
+        for (Canvas* canvas : mCanvases) {
+                Damage& damage = canvas->mDamage;
+                if (canvas->mVisible) {
+                        for (unsigned int row = damage.top(); row < damage.bottom(); row++) {
+                                if (damage.left(row) < damage.right(row)) damageCanvas(*canvas, row, damage.left(row), row + 1, damage.right(row));
+                        }
+                }
+                damage.clear();
+        }
+        top = mScreenDamage.top();
+        bottom = mScreenDamage.bottom();
+        for (unsigned int row = mScreenDamage.top(); row < mScreenDamage.bottom(); row++) {
+                if (mScreenDamage.left(row) >= mScreenDamage.right(row)) continue;
+                // Also the columns next to the damage, in case present() has removed a wide character there that an edge of
+                // a canvas broke, and which is whole again if the canvas has moved.
+                int64_t left = std::max(int64_t(mScreenDamage.left(row)) - 1, int64_t(0));
+                int64_t right = std::min(mScreenDamage.right(row) + 1, mColumns);
+                Cell* composed = mComposedBuffer.row(row);
+                Cell const* back = mBackBuffer.row(row);
+                std::copy(back + left, back + right, composed + left);
+                for (Canvas const* canvas : mCanvases) {
+                        if (!canvas->mVisible) continue;
+                        Canvas::Area clip = canvas->clipArea();
+                        int64_t originTop = canvas->screenTop(mRows), originLeft = canvas->mColumn;
+                        int64_t canvasRow = int64_t(row) - originTop;
+                        if (canvasRow < clip.top || canvasRow >= clip.bottom) continue;
+                        int64_t from = std::max(left, originLeft + clip.left), to = std::min(right, originLeft + clip.right);
+                        if (from >= to) continue;
+                        Cell const* cells = canvas->mBuffer.row(unsigned(canvasRow)) + (from - originLeft);
+                        std::copy(cells, cells + (to - from), composed + from);
+                        // Half of a wide character cut off by an edge of the canvas would look whole next to the other half
+                        // of one below, so blank it like present() does with other broken halves.
+                        if (from == originLeft + clip.left && composed[from].codepoint() == Cell::WIDE_CONTINUATION) composed[from] = Cell(' ', composed[from].style());
+                        if (to == originLeft + clip.right && composed[to - 1].width() == 2) composed[to - 1] = Cell(' ', composed[to - 1].style());
+                }
+        }
+        mScreenDamage.clear();
+}
+
+void Terminal::presentCopies() {
+        if (!hasCapability(Capability::RECTANGULAR_EDITING)) mCopyHints.clear();
+        for (CopyHint const& hint : mCopyHints) {
+                // Count the cells the copy would make right, and those already right that it would overwrite with something else.
+                unsigned int fixed = 0, broken = 0;
+                for (unsigned int row = 0; row < hint.bottom - hint.top; row++) {
+                        Cell const* source = mFrontBuffer.row(hint.top + row) + hint.left;
+                        Cell const* front = mFrontBuffer.row(hint.toTop + row) + hint.toLeft;
+                        Cell const* back = mBackBuffer.row(hint.toTop + row) + hint.toLeft;
+                        for (unsigned int column = 0; column < hint.right - hint.left; column++) {
+                                if (front[column] == back[column]) {
+                                        if (source[column] != back[column]) broken++;
+                                } else if (source[column] == back[column]) {
+                                        fixed++;
+                                }
+                        }
+                }
+                size_t cost = Csi::DECCRA::length(hint.top + 1, hint.left + 1, hint.bottom, hint.right, 1, hint.toTop + 1, hint.toLeft + 1, 1);
+                // Each cell costs at least a byte to draw.
+                if (fixed <= broken + cost) continue;
+                emit<Csi::DECCRA>(hint.top + 1, hint.left + 1, hint.bottom, hint.right, 1, hint.toTop + 1, hint.toLeft + 1, 1);
+                // Wide characters split by the edges of the destination are broken, while halves copied without their other
+                // half do not match a wide character in the back buffer and so are drawn again by presentRow().
+                mFrontBuffer.splitWideCharacters(hint.toTop, hint.toLeft, hint.toTop + hint.bottom - hint.top, hint.toLeft + hint.right - hint.left, UNKNOWN_CELL);
+                mFrontBuffer.copyRectangle(hint.top, hint.left, hint.bottom, hint.right, hint.toTop, hint.toLeft);
+        }
+        mCopyHints.clear();
+}
+
+void Terminal::presentRow(unsigned int row, unsigned int blankRowsFrom) {
+        Cell* front = mFrontBuffer.row(row);
+        Cell const* back = mBackBuffer.row(row);
+        // Drawing over either half of a wide character on the screen erases the other half, so that has to be drawn again.
+        for (unsigned int column = 0; column < mColumns; column++) {
+                if (front[column] == back[column]) continue;
+                if (front[column].width() == 2 && column + 1 < mColumns) {
+                        front[column + 1] = UNKNOWN_CELL;
+                } else if (front[column].codepoint() == Cell::WIDE_CONTINUATION && column > 0) {
+                        front[column - 1] = UNKNOWN_CELL;
+                }
+        }
+
+        unsigned int column = 0;
+        while (column < mColumns) {
+                if (front[column] == back[column]) {
+                        column++;
+                        continue;
+                }
+                Cell const cell = back[column];
+                if (cell.width() == 2 || cell.codepoint() == Cell::WIDE_CONTINUATION) {
+                        // A wide character is drawn as a whole, from its left half.
+                        unsigned int left = (cell.width() == 2) ? column : column - 1;
+                        moveRealCursor(row, left);
+                        presentCell(back[left]);
+                        front[left] = back[left];
+                        front[left + 1] = back[left + 1];
+                        column = left + 2;
+                        continue;
+                }
+                unsigned int runEnd = column + 1;
+                while (runEnd < mColumns && back[runEnd] == cell) runEnd++;
+                // Erasing the rest of the screen is the cheapest of all, so only look for a rectangle when that is not possible.
+                bool eraseBelow = runEnd == mColumns && row + 1 >= blankRowsFrom && cell == Cell();
+                if (!eraseBelow && runEnd - column > 1 && hasCapability(Capability::RECTANGULAR_EDITING) && presentRectangle(row, column, runEnd, cell)) {
+                        column = runEnd;
+                        continue;
+                }
+                // Cells at the end of the run that are already right need not be sent, except by erasing the rest of the line.
+                unsigned int end = runEnd;
+                while (front[end - 1] == back[end - 1]) end--;
+                unsigned int count = end - column;
+
+                size_t literalCost = count * glyphLength(cell);
+                size_t repeatCost = SIZE_MAX, eraseCost = SIZE_MAX, eraseLineCost = SIZE_MAX;
+                if (count > 1 && repeatable(cell)) repeatCost = glyphLength(cell) + Csi::REP::length(count - 1);
+                if (erasable(cell)) {
+                        // Erasing leaves the cursor in place, so it has to move past the erased cells if the next change is right after them.
+                        bool changeAfter = end < mColumns && front[end] != back[end];
+                        eraseCost = (count == 1 ? Csi::ECH::length() : Csi::ECH::length(count)) + (changeAfter ? Csi::CUF::length(count) : 0);
+                        if (runEnd == mColumns) eraseLineCost = Csi::EL::length();
+                }
+
+                moveRealCursor(row, column);
+                if (eraseLineCost <= std::min({literalCost, repeatCost, eraseCost})) {
+                        presentErasingStyle(cellStyle(cell).background());
+                        if (eraseBelow) {
+                                // Everything below is blank as well, so erase it at the same time.
+                                emit<Csi::ED>();
+                                mFrontBuffer.fillRectangle(row + 1, 0, mRows, mColumns, cell);
+                        } else {
+                                emit<Csi::EL>();
+                        }
+                        end = mColumns;
+                } else if (eraseCost <= std::min(literalCost, repeatCost)) {
+                        presentErasingStyle(cellStyle(cell).background());
+                        if (count == 1) emit<Csi::ECH>(); else emit<Csi::ECH>(count);
+                } else if (repeatCost < literalCost) {
+                        presentCell(cell);
+                        emit<Csi::REP>(count - 1);
+                        if (mPresentedColumn != UINT32_MAX) {
+                                mPresentedColumn = column + count;
+                                // Ending in the last column leaves a pending wrap, as in presentCell().
+                                if (mPresentedColumn >= mColumns) mPresentedRow = mPresentedColumn = UINT32_MAX;
+                        }
+                } else {
+                        for (unsigned int i = column; i < end; i++) presentCell(cell);
+                }
+                for (unsigned int i = column; i < end; i++) front[i] = cell;
+                column = end;
+        }
+}
+
+bool Terminal::presentRectangle(unsigned int row, unsigned int column, unsigned int right, Cell const& cell) {
+        bool erase = erasable(cell) && cellStyle(cell).background() == Style::defaultColor();
+        if (!erase && !fillableByDecfra(cell.codepoint())) return false;
+        // Extend down over the rows with the same cells, adding up what sending their changes row by row would cost.
+        size_t rowsCost = 0;
+        unsigned int bottom = row;
+        for (; bottom < mRows; bottom++) {
+                Cell const* front = mFrontBuffer.row(bottom);
+                Cell const* back = mBackBuffer.row(bottom);
+                unsigned int firstChange = right, lastChange = 0;
+                unsigned int i = column;
+                for (; i < right && back[i] == cell; i++) {
+                        if (front[i] == cell) continue;
+                        if (firstChange == right) firstChange = i;
+                        lastChange = i;
+                }
+                if (i < right) break;
+                if (firstChange < right) rowsCost += Csi::CUP::length(bottom + 1, firstChange + 1) + runCost(cell, lastChange + 1 - firstChange);
+        }
+        if (bottom - row < 2) return false;
+        size_t rectangleCost = erase ? Csi::DECERA::length(row + 1, column + 1, bottom, right)
+                : Csi::DECFRA::length(cell.codepoint(), row + 1, column + 1, bottom, right);
+        if (rectangleCost >= rowsCost) return false;
+        if (erase) {
+                // Erased cells get the current background on some terminals and the default on others, so make them agree.
+                presentErasingStyle(Style::defaultColor());
+                emit<Csi::DECERA>(row + 1, column + 1, bottom, right);
+        } else {
+                presentStyle(cellStyle(cell));
+                emit<Csi::DECFRA>(cell.codepoint(), row + 1, column + 1, bottom, right);
+        }
+        mFrontBuffer.splitWideCharacters(row, column, bottom, right, UNKNOWN_CELL);
+        mFrontBuffer.fillRectangle(row, column, bottom, right, cell);
+        return true;
+}
+
+size_t Terminal::runCost(Cell const& cell, unsigned int count) const {
+        size_t cost = count * glyphLength(cell);
+        if (count > 1 && repeatable(cell)) cost = std::min(cost, glyphLength(cell) + Csi::REP::length(count - 1));
+        if (erasable(cell)) cost = std::min(cost, count == 1 ? Csi::ECH::length() : Csi::ECH::length(count));
+        return cost;
+}
+
+bool Terminal::repeatable(Cell const& cell) const {
+        return hasCapability(Capability::REPEAT) && cell.width() == 1 && knownSingleWidth(cell.codepoint());
+}
+
+bool Terminal::erasable(Cell const& cell) const {
+        // Erased cells are not reversed or underlined, and without bce they always get the default background.
+        Style const& style = cellStyle(cell);
+        if (cell.codepoint() != ' ' || style.hasAttribute(Attribute::REVERSE) || style.hasAttribute(Attribute::UNDERLINE)) return false;
+        return style.background() == Style::defaultColor() || hasCapability(Capability::BACKGROUND_COLOR_ERASE);
+}
+
+void Terminal::presentScrolls(unsigned int changedTop, unsigned int changedBottom) {
+        mBackRowHashes.resize(mRows);
+        for (unsigned int row = changedTop; row < changedBottom; row++) mBackRowHashes[row] = mBackBuffer.rowHash(row);
+        hashFrontRows(changedTop, changedBottom);
+
+        unsigned int row = changedTop;
+        while (row < changedBottom) {
+                // Anchor on a changed row whose content occurs exactly once in the front buffer, at another row.
+                uint64_t hash = mBackRowHashes[row];
+                if (hash == mFrontRowHashes[row]) {
+                        row++;
+                        continue;
+                }
+                auto match = std::lower_bound(mFrontRowsByHash.begin(), mFrontRowsByHash.end(), std::make_pair(hash, 0u));
+                if (match == mFrontRowsByHash.end() || match->first != hash || (match + 1 != mFrontRowsByHash.end() && (match + 1)->first == hash)) {
+                        row++;
+                        continue;
+                }
+                int shift = int(match->second) - int(row);
+
+                // Extend to the neighbouring rows that have moved the same distance.
+                unsigned int top = row, bottom = row + 1;
+                while (top > changedTop && int(top) - 1 + shift >= int(changedTop) && mBackRowHashes[top - 1] == mFrontRowHashes[top - 1 + shift]
+                                && mBackRowHashes[top - 1] != mFrontRowHashes[top - 1]) top--;
+                while (bottom < changedBottom && int(bottom) + shift < int(changedBottom) && mBackRowHashes[bottom] == mFrontRowHashes[bottom + shift]) bottom++;
+
+                unsigned int savings = 0;
+                for (unsigned int r = top; r < bottom; r++) {
+                        Cell const* front = mFrontBuffer.row(r);
+                        Cell const* back = mBackBuffer.row(r);
+                        for (unsigned int column = 0; column < mColumns; column++) if (front[column] != back[column]) savings++;
+                }
+                if (savings >= SCROLL_MINIMUM_SAVINGS) {
+                        // Content moving up by shift means scrolling up the rows from top to where the moved rows came from.
+                        if (shift > 0) {
+                                scrollRealRegion(top, bottom + shift, shift);
+                        } else {
+                                scrollRealRegion(top + shift, bottom, shift);
+                        }
+                        hashFrontRows(changedTop, changedBottom);
+                }
+                row = bottom;
+        }
+}
+
+void Terminal::hashFrontRows(unsigned int top, unsigned int bottom) {
+        mFrontRowHashes.resize(mRows);
+        mFrontRowsByHash.clear();
+        for (unsigned int row = top; row < bottom; row++) {
+                mFrontRowHashes[row] = mFrontBuffer.rowHash(row);
+                mFrontRowsByHash.emplace_back(mFrontRowHashes[row], row);
+        }
+        std::sort(mFrontRowsByHash.begin(), mFrontRowsByHash.end());
+}
+
+void Terminal::scrollRealRegion(unsigned int top, unsigned int bottom, int lines) {
+        // Scrolled in lines are erased with the current background.
+        presentErasingStyle(Style::defaultColor());
+        unsigned int count = lines > 0 ? lines : -lines;
+        if (bottom == mRows) {
+                // No need for margins, since deleting and inserting lines affects everything below the cursor.
+                moveRealCursor(top, 0);
+                if (lines > 0) emit<Csi::DL>(count); else emit<Csi::IL>(count);
+                mPresentedColumn = 0;
+        } else {
+                emit<Csi::DECSTBM>(top + 1, bottom);
+                if (lines > 0) emit<Csi::SU>(count); else emit<Csi::SD>(count);
+                emit<Csi::DECSTBM>();
+                // Setting margins moves the cursor home.
+                mPresentedRow = mPresentedColumn = 0;
+        }
+        if (lines > 0) {
+                mFrontBuffer.scrollUp(top, bottom, count, Cell());
+        } else {
+                mFrontBuffer.scrollDown(top, bottom, count, Cell());
+        }
+}
+
+void Terminal::moveRealCursor(unsigned int row, unsigned int column) {
+        if (row == mPresentedRow && column == mPresentedColumn) return;
+
+        // Candidates are an absolute CUP, or relative vertical and horizontal movements if the position is known.
+        char best[2 * Csi::CUP::maxLength(2)];
+        int bestLength = int(((row == 0 && column == 0) ? Csi::CUP::write(best) : Csi::CUP::write(best, row + 1, column + 1)) - best);
+        bool rewrite = false;
+
+        if (mPresentedRow != UINT32_MAX) {
+                char relative[sizeof(best)];
+                char* end = relative;
+                if (row != mPresentedRow) {
+                        if (row > mPresentedRow) {
+                                end = (row - mPresentedRow == 1) ? Csi::CUD::write(end) : Csi::CUD::write(end, row - mPresentedRow);
+                        } else {
+                                end = (mPresentedRow - row == 1) ? Csi::CUU::write(end) : Csi::CUU::write(end, mPresentedRow - row);
+                        }
+                }
+                if (column != mPresentedColumn) {
+                        if (column == 0) {
+                                *end++ = '\r';
+                        } else if (column > mPresentedColumn) {
+                                end = (column - mPresentedColumn == 1) ? Csi::CUF::write(end) : Csi::CUF::write(end, column - mPresentedColumn);
+                        } else {
+                                end = (mPresentedColumn - column == 1) ? Csi::CUB::write(end) : Csi::CUB::write(end, mPresentedColumn - column);
+                        }
+                }
+                int length = int(end - relative);
+                if (length < bestLength) {
+                        memcpy(best, relative, length);
+                        bestLength = length;
+                }
+
+                // Moving right on the same row may be done cheaper by writing out the unchanged cells in between again.
+                if (row == mPresentedRow && column > mPresentedColumn && int(column - mPresentedColumn) < bestLength) {
+                        rewrite = true;
+                        Cell const* front = mFrontBuffer.row(row);
+                        for (unsigned int i = mPresentedColumn; i < column; i++) {
+                                Cell const& cell = front[i];
+                                if (cell.codepoint() >= 0x80 || cellStyle(cell) != mPresentedStyle) {
+                                        rewrite = false;
+                                        break;
+                                }
+                        }
+                }
+        }
+
+        if (rewrite) {
+                Cell const* front = mFrontBuffer.row(row);
+                for (unsigned int i = mPresentedColumn; i < column; i++) mOutput.append(char(front[i].codepoint()));
+        } else {
+                mOutput.append(best, bestLength);
+        }
+        mPresentedRow = row;
+        mPresentedColumn = column;
+}
+
+/** The parameters of SGR for turning each Attribute on and off. */
+static const uint32_t ATTRIBUTE_ON_PARAMETERS[] = { 1, 3, 4, 7 };
+static const uint32_t ATTRIBUTE_OFF_PARAMETERS[] = { 22, 23, 24, 27 };
+/** Resetting, every attribute and two colors of five parameters each. */
+static const size_t MAX_SGR_PARAMETERS = 1 + sizeof(ATTRIBUTE_ON_PARAMETERS) / sizeof(uint32_t) + 2 * 5;
+
+/** The index of the color in the 256 color palette closest to the given 24-bit color, not counting the first 16
+ * colors that terminals tend to change. */
+static uint8_t closestIndexedColor(uint32_t rgb) {
+        static const uint8_t CUBE_LEVELS[] = { 0, 95, 135, 175, 215, 255 };
+        int channels[3] = { int(rgb >> 16), int((rgb >> 8) & 0xFF), int(rgb & 0xFF) };
+        int cube[3];
+        for (int i = 0; i < 3; i++) {
+                // The levels are 40 apart except for the first step, so round to the nearest one.
+                int level = channels[i] < 48 ? 0 : (channels[i] < 115 ? 1 : (channels[i] - 35) / 40);
+                cube[i] = level;
+        }
+        int cubeDistance = 0;
+        for (int i = 0; i < 3; i++) cubeDistance += (channels[i] - CUBE_LEVELS[cube[i]]) * (channels[i] - CUBE_LEVELS[cube[i]]);
+        // The gray ramp from 8 to 238 in steps of 10.
+        int average = (channels[0] + channels[1] + channels[2]) / 3;
+        int grayLevel = average < 8 ? 0 : (average > 238 ? 23 : (average - 3) / 10);
+        int gray = 8 + grayLevel * 10;
+        int grayDistance = 0;
+        for (int i = 0; i < 3; i++) grayDistance += (channels[i] - gray) * (channels[i] - gray);
+        if (grayDistance < cubeDistance) return uint8_t(232 + grayLevel);
+        return uint8_t(16 + 36 * cube[0] + 6 * cube[1] + cube[2]);
+}
+
+/** Write the SGR parameters setting the color as foreground, or as background if base is 40 instead of 30. */
+static uint32_t* colorParameters(uint32_t* out, uint32_t color, uint32_t base, bool trueColor) {
+        uint32_t value = Style::colorValue(color);
+        switch (Style::colorKind(color)) {
+                case Style::COLOR_DEFAULT:
+                        *out++ = base + 9;
+                        break;
+                case Style::COLOR_INDEXED:
+                        if (value < 8) {
+                                *out++ = base + value;
+                        } else if (value < 16) {
+                                *out++ = base + 60 + value - 8;
+                        } else {
+                                *out++ = base + 8; *out++ = 5; *out++ = value;
+                        }
+                        break;
+                default:
+                        if (trueColor) {
+                                *out++ = base + 8; *out++ = 2; *out++ = value >> 16; *out++ = (value >> 8) & 0xFF; *out++ = value & 0xFF;
+                        } else {
+                                *out++ = base + 8; *out++ = 5; *out++ = closestIndexedColor(value);
+                        }
+                        break;
+        }
+        return out;
+}
+
+static size_t parametersLength(uint32_t const* parameters, size_t count) {
+        size_t length = 0;
+        for (size_t i = 0; i < count; i++) length += decimalLength(parameters[i]) + 1;
+        return length;
+}
+
+void Terminal::presentStyle(Style style) {
+        if (style == mPresentedStyle) return;
+        bool trueColor = hasCapability(Capability::TRUE_COLOR);
+
+        // Either change what differs, or reset everything and set what is not the default, whichever is shorter.
+        uint32_t changes[MAX_SGR_PARAMETERS];
+        uint32_t* changesEnd = changes;
+        unsigned int attributesFrom = mPresentedStyle.attributes(), attributesTo = style.attributes();
+        for (unsigned int i = 0; i < sizeof(ATTRIBUTE_ON_PARAMETERS) / sizeof(uint32_t); i++) {
+                unsigned int bit = 1u << i;
+                if ((attributesFrom & bit) != (attributesTo & bit)) *changesEnd++ = (attributesTo & bit) ? ATTRIBUTE_ON_PARAMETERS[i] : ATTRIBUTE_OFF_PARAMETERS[i];
+        }
+        if (style.foreground() != mPresentedStyle.foreground()) changesEnd = colorParameters(changesEnd, style.foreground(), 30, trueColor);
+        if (style.background() != mPresentedStyle.background()) changesEnd = colorParameters(changesEnd, style.background(), 40, trueColor);
+
+        uint32_t reset[MAX_SGR_PARAMETERS];
+        uint32_t* resetEnd = reset;
+        *resetEnd++ = 0;
+        for (unsigned int i = 0; i < sizeof(ATTRIBUTE_ON_PARAMETERS) / sizeof(uint32_t); i++) {
+                if (attributesTo & (1u << i)) *resetEnd++ = ATTRIBUTE_ON_PARAMETERS[i];
+        }
+        if (style.foreground() != Style::defaultColor()) resetEnd = colorParameters(resetEnd, style.foreground(), 30, trueColor);
+        if (style.background() != Style::defaultColor()) resetEnd = colorParameters(resetEnd, style.background(), 40, trueColor);
+        // A lone reset can be sent without its parameter.
+        size_t resetCount = (resetEnd - reset == 1) ? 0 : resetEnd - reset;
+
+        uint32_t const* parameters = changes;
+        size_t count = changesEnd - changes;
+        if (parametersLength(reset, resetCount) < parametersLength(changes, count)) {
+                parameters = reset;
+                count = resetCount;
+        }
+        char* out = mOutput.reserve(Csi::SGR::maxLength(count));
+        mOutput.commit(Csi::SGR::writeArray(out, parameters, count) - out);
+        outputWritten();
+        mPresentedStyle = style;
+}
+
+void Terminal::presentCell(Cell const& cell) {
+        presentStyle(cellStyle(cell));
+
+        uint32_t codepoint = cell.codepoint();
+        if (cell.isGrapheme()) {
+                ByteSpan text = mGraphemes.text(cell.graphemeHandle());
+                mOutput.append((char const*) text.data, text.length);
+        } else {
+                char* utf8 = mOutput.reserve(4);
+                mOutput.commit(writeUtf8(utf8, codepoint) - utf8);
+        }
+
+        if (mPresentedColumn == UINT32_MAX) return;
+        // Clusters of several code points count as neither.
+        bool knownWidth = (cell.width() == 2) ? codepointWidth(codepoint) == 2 : knownSingleWidth(codepoint);
+        if (!knownWidth || mPresentedColumn + cell.width() >= mColumns) {
+                // Terminals disagree on the width of emoji and other clusters, and the last column leaves the
+                // cursor in a pending wrap state, so position absolutely next time.
+                mPresentedRow = mPresentedColumn = UINT32_MAX;
+        } else {
+                mPresentedColumn += cell.width();
+        }
+}
+
+uint32_t StyleTable::intern(Style style) {
+        uint64_t hash = style.word() * 0x9E3779B97F4A7C15ull;
+        uint32_t& slot = mSlots.find(hash >> 32, [&](uint32_t index) { return mStyles[index] == style; });
+        if (slot != InternSlots::EMPTY) return slot;
+        uint32_t index = uint32_t(mStyles.size());
+        mStyles.push_back(style);
+        if (mSlots.full(mStyles.size())) rehash(mStyles.size()); else slot = index;
+        return index;
+}
+
+void StyleTable::compact(std::vector<uint32_t>& remap) {
+        // The default style stays at index 0.
+        remap[0] = 0;
+        size_t count = 0;
+        for (size_t index = 0; index < mStyles.size(); index++) {
+                if (remap[index] == UINT32_MAX) continue;
+                mStyles[count] = mStyles[index];
+                remap[index] = uint32_t(count++);
+        }
+        mStyles.resize(count);
+        rehash(count);
+}
+
+void StyleTable::rehash(size_t count) {
+        mSlots.reset(count);
+        for (uint32_t index = 0; index < mStyles.size(); index++) {
+                uint64_t hash = mStyles[index].word() * 0x9E3779B97F4A7C15ull;
+                mSlots.find(hash >> 32, [](uint32_t) { return false; }) = index;
+        }
+}
+
+namespace {
+        uint64_t bytesHash(uint8_t const* bytes, size_t length) {
+                // FNV-1a
+                uint64_t hash = 14695981039346656037ull;
+                for (size_t i = 0; i < length; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+                return hash;
+        }
+}
+
+uint32_t GraphemePool::intern(uint8_t const* text, size_t length) {
+        uint32_t& slot = mSlots.find(bytesHash(text, length), [&](uint32_t handle) {
+                ByteSpan other = this->text(handle);
+                return other.length == length && memcmp(other.data, text, length) == 0;
+        });
+        if (slot != InternSlots::EMPTY) return slot;
+        if (size() >= MAX_HANDLES) return UINT32_MAX;
+        uint32_t handle = uint32_t(size());
+        mBytes.insert(mBytes.end(), text, text + length);
+        mOffsets.push_back(uint32_t(mBytes.size()));
+        if (mSlots.full(size())) rehash(size()); else slot = handle;
+        return handle;
+}
+
+void GraphemePool::compact(std::vector<uint32_t>& remap) {
+        size_t count = 0;
+        uint32_t end = 0;
+        for (size_t handle = 0; handle < size(); handle++) {
+                if (remap[handle] == UINT32_MAX) continue;
+                uint32_t start = mOffsets[handle], length = mOffsets[handle + 1] - start;
+                memmove(mBytes.data() + end, mBytes.data() + start, length);
+                // Offsets are only overwritten after they have been read, as count never passes handle.
+                mOffsets[count] = end;
+                end += length;
+                remap[handle] = uint32_t(count++);
+        }
+        mOffsets[count] = end;
+        mOffsets.resize(count + 1);
+        mBytes.resize(end);
+        rehash(count);
+}
+
+void GraphemePool::rehash(size_t count) {
+        mSlots.reset(count);
+        for (uint32_t handle = 0; handle < size(); handle++) {
+                ByteSpan bytes = text(handle);
+                mSlots.find(bytesHash(bytes.data, bytes.length), [](uint32_t) { return false; }) = handle;
+        }
+}
+
+void ScreenBuffer::resize(Size size) {
+        unsigned int rows = size.rows, columns = size.columns;
+        if (rows == mRows && columns == mColumns) return;
+        if (mCells.size() < size_t(rows) * columns) mCells.resize(size_t(rows) * columns);
+        unsigned int keepRows = std::min(rows, mRows);
+        if (columns < mColumns) {
+                // The rows move towards the start, so move the top one first.
+                for (unsigned int row = 1; row < keepRows; row++) {
+                        memmove(&mCells[size_t(row) * columns], &mCells[size_t(row) * mColumns], columns * sizeof(Cell));
+                }
+        } else if (columns > mColumns) {
+                for (unsigned int row = keepRows; row-- > 0;) {
+                        Cell* cells = &mCells[size_t(row) * columns];
+                        memmove(cells, &mCells[size_t(row) * mColumns], mColumns * sizeof(Cell));
+                        std::fill(cells + mColumns, cells + columns, Cell());
+                }
+        }
+        std::fill(mCells.begin() + size_t(keepRows) * columns, mCells.begin() + size_t(rows) * columns, Cell());
+        mRows = rows;
+        mColumns = columns;
+}
+
+uint64_t ScreenBuffer::rowHash(unsigned int r) const {
+        // FNV-1a over the content of the cells.
+        uint64_t hash = 14695981039346656037ull;
+        Cell const* cells = row(r);
+        for (unsigned int column = 0; column < mColumns; column++) {
+                hash = (hash ^ cells[column].word()) * 1099511628211ull;
+        }
+        return hash;
+}
+
+void ScreenBuffer::fillRectangle(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, Cell const& cell) {
+        if (bottom > mRows) bottom = mRows;
+        if (right > mColumns) right = mColumns;
+        for (unsigned int r = top; r < bottom; r++) {
+                Cell* cells = row(r);
+                for (unsigned int column = left; column < right; column++) cells[column] = cell;
+        }
+}
+
+void ScreenBuffer::copyRectangle(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, unsigned int toTop, unsigned int toLeft) {
+        // Copy the rows in the order that does not overwrite rows before they have been copied.
+        unsigned int rows = bottom - top;
+        for (unsigned int i = 0; i < rows; i++) {
+                unsigned int r = (toTop > top) ? rows - 1 - i : i;
+                memmove(row(toTop + r) + toLeft, row(top + r) + left, (right - left) * sizeof(Cell));
+        }
+}
+
+void ScreenBuffer::removeBrokenWideCharacters(unsigned int r) {
+        Cell* cells = row(r);
+        for (unsigned int column = 0; column < mColumns; column++) {
+                Cell& cell = cells[column];
+                bool broken = (cell.width() == 2) ? (column + 1 == mColumns || cells[column + 1].codepoint() != Cell::WIDE_CONTINUATION)
+                        : (cell.codepoint() == Cell::WIDE_CONTINUATION && (column == 0 || cells[column - 1].width() != 2));
+                if (broken) cell = Cell(' ', cell.style());
+        }
+}
+
+void ScreenBuffer::splitWideCharacters(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, Cell const& replacement) {
+        for (unsigned int r = top; r < bottom; r++) {
+                Cell* cells = row(r);
+                if (left > 0 && left < mColumns && cells[left].codepoint() == Cell::WIDE_CONTINUATION) cells[left - 1] = replacement;
+                if (right < mColumns && cells[right].codepoint() == Cell::WIDE_CONTINUATION) cells[right] = replacement;
+        }
+}
+
+void ScreenBuffer::scrollUp(unsigned int top, unsigned int bottom, unsigned int lines, Cell const& blank) {
+        if (lines > bottom - top) lines = bottom - top;
+        memmove(row(top), row(top + lines), size_t(bottom - top - lines) * mColumns * sizeof(Cell));
+        fillRectangle(bottom - lines, 0, bottom, mColumns, blank);
+}
+
+void ScreenBuffer::scrollDown(unsigned int top, unsigned int bottom, unsigned int lines, Cell const& blank) {
+        if (lines > bottom - top) lines = bottom - top;
+        memmove(row(top + lines), row(top), size_t(bottom - top - lines) * mColumns * sizeof(Cell));
+        fillRectangle(top, 0, top + lines, mColumns, blank);
+}
+
+void Damage::add(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right) {
+        if (bottom > mSpans.size()) bottom = unsigned(mSpans.size());
+        if (top >= bottom || left >= right) return;
+        for (unsigned int row = top; row < bottom; row++) {
+                Span& span = mSpans[row];
+                if (left < span.left) span.left = left;
+                if (right > span.right) span.right = right;
+        }
+        if (top < mTop) mTop = top;
+        if (bottom > mBottom) mBottom = bottom;
+}
+
+void Damage::clear() {
+        for (unsigned int row = mTop; row < mBottom; row++) mSpans[row] = Span{UINT32_MAX, 0};
+        mTop = unsigned(mSpans.size());
+        mBottom = 0;
+}
+
+Canvas::Canvas(Terminal& terminal, int column, int row, unsigned int columns, unsigned int rows, int z)
+        : mTerminal(terminal), mSize{rows, columns}, mColumn(column), mRow(row), mZ(z) {
+        mBuffer.resize(mSize);
+        mState = DrawState{rows, columns, 0, 0, 0, rows, false};
+        mDamage.reset(rows);
+        mTerminal.addCanvas(this);
+}
+
+Canvas::~Canvas() {
+        mTerminal.removeCanvas(this);
+}
+
+Canvas& Canvas::moveTo(int column, int row) {
+        if (column == mColumn && row == mRow) return *this;
+        int64_t top = screenTop(mTerminal.screenSize().rows), left = mColumn;
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        mColumn = column;
+        mRow = row;
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        mTerminal.hintCanvasMove(*this, top, left);
+        return *this;
+}
+
+Canvas& Canvas::resize(unsigned int columns, unsigned int rows) {
+        if (columns == mSize.columns && rows == mSize.rows) return *this;
+        if (mTerminal.drawingOn() == this) mTerminal.drawOn(nullptr);
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        mSize = Size{rows, columns};
+        mBuffer.resize(mSize);
+        // Like the screen on resize, with the cursor kept inside and the scrolling region reset.
+        mState.rows = rows;
+        mState.columns = columns;
+        if (mState.cursorRow >= rows) mState.cursorRow = rows > 0 ? rows - 1 : 0;
+        if (mState.cursorColumn >= columns) mState.cursorColumn = columns > 0 ? columns - 1 : 0;
+        mState.marginTop = 0;
+        mState.marginBottom = rows;
+        mState.wrapPending = false;
+        mDamage.reset(rows);
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        return *this;
+}
+
+Canvas& Canvas::setZ(int z) {
+        mZ = z;
+        return raise();
+}
+
+Canvas& Canvas::raise() {
+        mSequence = mTerminal.mCanvasSequence++;
+        mTerminal.sortCanvases();
+        // Only where it overlaps others has changed, but that is within its own area.
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        return *this;
+}
+
+Canvas& Canvas::setVisible(bool visible) {
+        if (visible == mVisible) return *this;
+        mVisible = visible;
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        return *this;
+}
+
+Canvas& Canvas::setClip(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows) {
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        mClipColumn = column;
+        mClipRow = row;
+        mClipColumns = columns;
+        mClipRows = rows;
+        mTerminal.damageCanvas(*this, 0, 0, mSize.rows, mSize.columns);
+        return *this;
+}
+
+Canvas::Area Canvas::clipArea() const {
+        int64_t rows = mSize.rows, columns = mSize.columns;
+        Area area;
+        area.top = std::max(rows - int64_t(mClipRow) - int64_t(mClipRows), int64_t(0));
+        area.bottom = std::max(rows - int64_t(mClipRow), int64_t(0));
+        area.left = std::min(int64_t(mClipColumn), columns);
+        area.right = std::min(int64_t(mClipColumn) + int64_t(mClipColumns), columns);
+        return area;
+}
+
+void OutputBuffer::appendFormatted(char const* fmt, va_list argp) {
+        va_list argpCopy;
+        va_copy(argpCopy, argp);
+        size_t available = mCapacity - mSize;
+        int length = vsnprintf(mData + mSize, available, fmt, argp);
+        if (length >= 0 && size_t(length) >= available) {
+                vsnprintf(reserve(length + 1), length + 1, fmt, argpCopy);
+        }
+        va_end(argpCopy);
+        if (length > 0) mSize += length;
+}
+
+void OutputBuffer::grow(size_t minimumCapacity) {
+        size_t capacity = mCapacity < 4096 ? 4096 : mCapacity * 2;
+        if (capacity < minimumCapacity) capacity = minimumCapacity;
+        char* data = (char*) realloc(mData, capacity);
+        if (data == nullptr) {
+                perror("realloc()");
+                exit(1);
+        }
+        mData = data;
+        mCapacity = capacity;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+        uint64_t wanted = uint64_t(fraction * count + 0.5);
+        uint64_t seen = 0;
+        for (unsigned int bucket = 0; bucket < BUCKETS; bucket++) {
+                seen += buckets[bucket];
+                if (seen >= wanted && seen > 0) return (bucket == BUCKETS - 1) ? maxNanos : std::min(maxNanos, (uint64_t(1) << bucket) - 1);
+        }
+        return maxNanos;
+}
+
+static void dumpHistogram(int fd, char const* name, LatencyHistogram const& histogram, bool last) {
+        dprintf(fd, "  \"%s\": {\"count\": %llu, \"mean_ns\": %llu, \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, \"buckets\": [",
+                        name, (unsigned long long) histogram.count, (unsigned long long) (histogram.count ? histogram.totalNanos / histogram.count : 0),
+                        (unsigned long long) histogram.percentile(0.5), (unsigned long long) histogram.percentile(0.9),
+                        (unsigned long long) histogram.percentile(0.99), (unsigned long long) histogram.maxNanos);
+        for (unsigned int bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++) {
+                dprintf(fd, "%s%llu", bucket > 0 ? ", " : "", (unsigned long long) histogram.buckets[bucket]);
+        }
+        dprintf(fd, "]}%s\n", last ? "" : ",");
+}
+
+void TerminalStats::dump(int fd) const {
+        static char const* const EVENT_NAMES[] = {"key", "mouse_down", "mouse_up", "mouse_moved_pressed", "char", "resize", "timeout", "paste", "text", "mouse_moved", "focus_in", "focus_out", "capabilities", "input_ended", "cursor_position"};
+        static char const* const PARSE_ERROR_NAMES[] = {"unknown_escape", "unknown_tilde_key", "tilde_arguments", "mouse_arguments", "unknown_ss3",
+                "too_many_arguments", "argument_too_long", "invalid_utf8"};
+        static_assert(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == size_t(EventType::NONE), "A name for every EventType");
+        static_assert(sizeof(PARSE_ERROR_NAMES) / sizeof(PARSE_ERROR_NAMES[0]) == PARSE_ERROR_KINDS, "A name for every ParseError");
+
+        dprintf(fd, "{\n  \"bytes_written\": %llu, \"write_calls\": %llu, \"flushes\": %llu, \"bytes_read\": %llu, \"read_calls\": %llu,\n",
+                        (unsigned long long) bytesWritten, (unsigned long long) writeCalls, (unsigned long long) flushes,
+                        (unsigned long long) bytesRead, (unsigned long long) readCalls);
+        dprintf(fd, "  \"presents\": %llu, \"changed_presents\": %llu,\n", (unsigned long long) presents, (unsigned long long) changedPresents);
+        dprintf(fd, "  \"events\": {");
+        for (size_t type = 0; type < size_t(EventType::NONE); type++) {
+                dprintf(fd, "%s\"%s\": %llu", type > 0 ? ", " : "", EVENT_NAMES[type], (unsigned long long) events[type]);
+        }
+        dprintf(fd, "},\n  \"parse_errors\": {");
+        for (size_t kind = 0; kind < PARSE_ERROR_KINDS; kind++) {
+                dprintf(fd, "%s\"%s\": %llu", kind > 0 ? ", " : "", PARSE_ERROR_NAMES[kind], (unsigned long long) parseErrors[kind]);
+        }
+        dprintf(fd, "},\n");
+        dumpHistogram(fd, "frame_encode", frameEncode, false);
+        dumpHistogram(fd, "input_to_present", inputToPresent, false);
+        dumpHistogram(fd, "await_blocked", awaitBlocked, true);
+        dprintf(fd, "}\n");
+}
@@ -9,162 +9,907 @@
 #include <stdarg.h>
 #include <stdlib.h>
 
-enum class EventType : uint8_t { KEY, MOUSE_DOWN, MOUSE_UP, MOUSE_MOVED_PRESSED, CHAR, RESIZE, TIMEOUT, PASTE, NONE };
-enum class Key : uint16_t { UP, DOWN, RIGHT, LEFT, F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12 };
-enum class ModifierKey : uint8_t { CTRL, SHIFT, ALT };
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "encoder.hpp"
+#include "terminalio.hpp"
+#include "textscan.hpp"
+#include "unicode.hpp"
+
+enum class EventType : uint8_t { KEY, MOUSE_DOWN, MOUSE_UP, MOUSE_MOVED_PRESSED, CHAR, RESIZE, TIMEOUT, PASTE, TEXT, MOUSE_MOVED, FOCUS_IN, FOCUS_OUT, CAPABILITIES, INPUT_ENDED, CURSOR_POSITION, NONE };
+/** BEGIN is the middle key of the keypad, and BACK_TAB is shift+tab, which terminals send as a key of its own. */
+enum class Key : uint16_t { UP, DOWN, RIGHT, LEFT, F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+        HOME, END, PAGE_UP, PAGE_DOWN, INSERT, DELETE, BEGIN, BACK_TAB };
+enum class ModifierKey : uint8_t { CTRL, SHIFT, ALT, META };
 enum class Color : uint16_t { BLACK, RED, GREEN, YELLOW, BLUE, MAGENTA, CYAN, WHITE, DEFAULT=9 };
-struct Size { unsigned int rows, columns; };
-enum class EscapeState { NONE, ESCAPE, ESCAPE_O, CSI, CSI_LOWERTHAN };
+/** Which mouse events to report: only presses and releases, also motion while a button is pressed, or all motion. */
+enum class MouseTracking : uint8_t { CLICKS, DRAG, ALL };
+/** Optional features of the terminal that present() and fillRectangle() may use when available:
+ * erasing with the current background color (bce), REP to repeat a character, the VT420 rectangular
+ * area operations DECFRA, DECERA and DECCRA, 24-bit colors, which are approximated otherwise, and
+ * synchronized updates (DEC private mode 2026). Bracketed paste (2004) and SGR mouse reports (1006)
+ * are only found out about by Terminal::probeCapabilities(), for the program to decide on. */
+enum class Capability : uint8_t { BACKGROUND_COLOR_ERASE, REPEAT, RECTANGULAR_EDITING, TRUE_COLOR, SYNCHRONIZED_UPDATES, BRACKETED_PASTE, SGR_MOUSE };
+/** Text attributes, which are combined as a bit mask of (1 << Attribute). */
+enum class Attribute : uint8_t { BOLD, ITALIC, UNDERLINE, REVERSE };
+
+/** The colors and attributes text is drawn with, packed into one word so that cells stay small and comparing
+ * styles is a single comparison. A color takes 26 bits: its kind above 24 bits of palette index or RGB. */
+class Style {
+        public:
+                static const uint32_t COLOR_DEFAULT = 0;
+                static const uint32_t COLOR_INDEXED = 1;
+                static const uint32_t COLOR_RGB = 2;
+
+                static constexpr uint32_t defaultColor() { return COLOR_DEFAULT << 24; }
+                /** An entry in the 256 color palette, where the first 8 are the basic colors and the next 8 their bright variants. */
+                static constexpr uint32_t indexedColor(uint8_t index) { return (COLOR_INDEXED << 24) | index; }
+                static constexpr uint32_t rgbColor(uint8_t red, uint8_t green, uint8_t blue) {
+                        return (COLOR_RGB << 24) | (uint32_t(red) << 16) | (uint32_t(green) << 8) | blue;
+                }
+                static constexpr uint32_t basicColor(Color color) { return color == Color::DEFAULT ? defaultColor() : indexedColor(uint8_t(color)); }
+                static uint32_t colorKind(uint32_t color) { return color >> 24; }
+                static uint32_t colorValue(uint32_t color) { return color & 0xFFFFFF; }
+
+                Style() = default;
+                uint32_t foreground() const { return uint32_t(mWord & COLOR_MASK); }
+                uint32_t background() const { return uint32_t((mWord >> BACKGROUND_SHIFT) & COLOR_MASK); }
+                /** Bit mask of (1 << Attribute). */
+                unsigned int attributes() const { return unsigned(mWord >> ATTRIBUTES_SHIFT); }
+                bool hasAttribute(Attribute attribute) const { return (attributes() & (1u << int(attribute))) != 0; }
+
+                Style withForeground(uint32_t color) const { return Style((mWord & ~COLOR_MASK) | color); }
+                Style withBackground(uint32_t color) const { return Style((mWord & ~(COLOR_MASK << BACKGROUND_SHIFT)) | (uint64_t(color) << BACKGROUND_SHIFT)); }
+                Style withAttribute(Attribute attribute, bool set) const {
+                        uint64_t bit = uint64_t(1) << (ATTRIBUTES_SHIFT + int(attribute));
+                        return Style(set ? (mWord | bit) : (mWord & ~bit));
+                }
+
+                uint64_t word() const { return mWord; }
+                bool operator==(Style const& other) const { return mWord == other.mWord; }
+                bool operator!=(Style const& other) const { return mWord != other.mWord; }
+        private:
+                static const uint64_t COLOR_MASK = (uint64_t(1) << 26) - 1;
+                static const unsigned int BACKGROUND_SHIFT = 26;
+                static const unsigned int ATTRIBUTES_SHIFT = 52;
+
+                explicit Style(uint64_t word) : mWord(word) {}
+                uint64_t mWord{0};
+};
+
+/** An input event together with the data for its type. */
+struct Event {
+        EventType type{EventType::NONE};
+        /** Bit mask of (1 << ModifierKey) for KEY, CHAR and mouse events. A CHAR only has modifiers when the terminal tells
+         * them, such as ALT for a character sent after an ESC, or with modifyOtherKeys or CSI u keyboard reporting. */
+        uint8_t modifiers{0};
+        /** For mouse events: 0-2 for left, middle and right, 3 for none and 4-7 for the wheel. */
+        uint8_t mouseButton{0};
+        /** For PASTE, if this is the last chunk of the paste. */
+        bool pasteFinished{false};
+        Key key{Key::UP};
+        /** For CHAR, the code point. */
+        uint32_t character{0};
+        /** For mouse events and CURSOR_POSITION, the position with row 0 at the bottom as for drawing. */
+        unsigned int row{0};
+        unsigned int column{0};
+        /** For TEXT and PASTE, the UTF-8 text. Only valid until the next await() or awaitBatch(). */
+        ByteSpan text{nullptr, 0};
+        /** For RESIZE, the new size. */
+        Size size{0, 0};
+        /** For INPUT_ENDED, the errno of the failed read or wait, or 0 if the input reached its end. */
+        int error{0};
+};
+/** The states of the input parser, which is a DFA over classes of bytes given by a table generated at compile time. */
+enum class EscapeState : uint8_t { GROUND, ESCAPE, SS3, CSI_ENTRY, CSI_PARAM, CSI_SUBPARAM, CSI_INTERMEDIATE, CSI_IGNORE, DCS_STRING, DCS_IGNORE, DCS_ESCAPE };
+/** What was wrong with input that could not be parsed. */
+enum class ParseError : uint8_t { UNKNOWN_ESCAPE, UNKNOWN_TILDE_KEY, TILDE_ARGUMENTS, MOUSE_ARGUMENTS, UNKNOWN_SS3, TOO_MANY_ARGUMENTS, ARGUMENT_TOO_LONG, INVALID_UTF8 };
+static const size_t PARSE_ERROR_KINDS = size_t(ParseError::INVALID_UTF8) + 1;
+
+/** Build with SCREENCANVAS_STATS=1 to have Terminal keep TerminalStats. Otherwise the statements in IF_STATS() are left out. */
+#ifndef SCREENCANVAS_STATS
+#define SCREENCANVAS_STATS 0
+#endif
+#if SCREENCANVAS_STATS
+#define IF_STATS(statement) statement
+#else
+#define IF_STATS(statement)
+#endif
+
+/** Counts of durations in buckets of powers of two nanoseconds, so that recording one is just a few instructions. */
+struct LatencyHistogram {
+        static const unsigned int BUCKETS = 40;
+        /** Bucket i counts the durations from 2^(i-1) up to 2^i nanoseconds, except that the last one also counts all longer. */
+        uint64_t buckets[BUCKETS]{};
+        uint64_t count{0};
+        uint64_t totalNanos{0};
+        uint64_t maxNanos{0};
+
+        void record(uint64_t nanos) {
+                unsigned int bucket = (nanos == 0) ? 0 : 64 - __builtin_clzll(nanos);
+                buckets[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+                count++;
+                totalNanos += nanos;
+                if (nanos > maxNanos) maxNanos = nanos;
+        }
+        /** An upper bound of the duration that the given fraction of the recorded ones are within. */
+        uint64_t percentile(double fraction) const;
+};
+
+/** What a Terminal has done since it was created, kept when built with SCREENCANVAS_STATS=1. */
+struct TerminalStats {
+        uint64_t bytesWritten{0};
+        /** The write() system calls that writing took, which is none for MemoryIo. */
+        uint64_t writeCalls{0};
+        /** Writes of buffered output to the TerminalIo. */
+        uint64_t flushes{0};
+        uint64_t bytesRead{0};
+        uint64_t readCalls{0};
+        /** Calls to present() in retained mode, and how many of those had changes to send. */
+        uint64_t presents{0};
+        uint64_t changedPresents{0};
+        /** Events returned, by EventType. */
+        uint64_t events[size_t(EventType::NONE)]{};
+        /** Input that could not be parsed and was skipped, by ParseError. */
+        uint64_t parseErrors[PARSE_ERROR_KINDS]{};
+        /** Time spent in present() for frames that had changes. */
+        LatencyHistogram frameEncode;
+        /** Time from reading input to the end of the first present() with changes after it. */
+        LatencyHistogram inputToPresent;
+        /** Time spent blocked waiting for input. */
+        LatencyHistogram awaitBlocked;
+
+        /** Write the stats as a JSON object. */
+        void dump(int fd) const;
+};
 
 #define WARN_UNUSED __attribute__((warn_unused_result))
 
+/** A growable buffer of output waiting to be written to the terminal. */
+class OutputBuffer {
+        public:
+                OutputBuffer() = default;
+                OutputBuffer(OutputBuffer const&) = delete;
+                OutputBuffer& operator=(OutputBuffer const&) = delete;
+                ~OutputBuffer() { free(mData); }
+
+                void append(char const* data, size_t length) { memcpy(reserve(length), data, length); mSize += length; }
+                void append(char c) { *reserve(1) = c; mSize++; }
+                void appendFormatted(char const* fmt, va_list argp);
+                /** Append a control sequence of the given shape, such as Csi::CUP, with the given parameters. */
+                template <typename Sequence, typename... Params>
+                void appendSequence(Params... params) {
+                        char* start = reserve(Sequence::maxLength(sizeof...(Params)));
+                        mSize += Sequence::write(start, params...) - start;
+                }
+                /** Make room for at least length more bytes, returning where to write them. Call commit() afterwards. */
+                char* reserve(size_t length) { if (mSize + length > mCapacity) grow(mSize + length); return mData + mSize; }
+                void commit(size_t length) { mSize += length; }
+
+                char const* data() const { return mData; }
+                size_t size() const { return mSize; }
+                bool empty() const { return mSize == 0; }
+                void clear() { mSize = 0; }
+                void truncate(size_t size) { if (size < mSize) mSize = size; }
+        private:
+                char* mData{nullptr};
+                size_t mSize{0};
+                size_t mCapacity{0};
+
+                void grow(size_t minimumCapacity);
+};
+
+/** An open addressing hash table of indices into entries that are kept elsewhere, for interning them. */
+class InternSlots {
+        public:
+                static constexpr uint32_t EMPTY = UINT32_MAX;
+
+                /** The slot holding the index for which equal(index) is true, or the empty slot where it belongs. */
+                template <typename Equal>
+                uint32_t& find(uint64_t hash, Equal const& equal) {
+                        size_t mask = mSlots.size() - 1;
+                        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                                uint32_t& slot = mSlots[i];
+                                if (slot == EMPTY || equal(slot)) return slot;
+                        }
+                }
+                /** If one more than count entries needs more slots, which is then done by reset() and inserting all again. */
+                bool full(size_t count) const { return (count + 1) * 2 > mSlots.size(); }
+                /** Empty all slots, with room for at least count entries. Does not allocate when shrinking. */
+                void reset(size_t count) {
+                        size_t size = 16;
+                        while (size < count * 2) size *= 2;
+                        mSlots.assign(size, EMPTY);
+                }
+        private:
+                std::vector<uint32_t> mSlots = std::vector<uint32_t>(16, EMPTY);
+};
+
+/** The styles in use, interned so that a cell can refer to its style with a 32-bit index. Index 0 is the default style. */
+class StyleTable {
+        public:
+                StyleTable() { intern(Style()); }
+                uint32_t intern(Style style);
+                Style const& operator[](uint32_t index) const { return mStyles[index]; }
+                size_t size() const { return mStyles.size(); }
+                /** Keep only the styles whose entry in remap is not UINT32_MAX, and replace the entries with their new indices. */
+                void compact(std::vector<uint32_t>& remap);
+        private:
+                std::vector<Style> mStyles;
+                InternSlots mSlots;
+
+                void rehash(size_t count);
+};
+
+/** Grapheme clusters of more than one code point, interned so that cells holding equal clusters are equal. The UTF-8
+ * of all of them is kept after each other in one arena, which compact() packs in place to reuse the memory. */
+class GraphemePool {
+        public:
+                /** The largest number of clusters, given by the bits a Cell has for a handle. */
+                static const size_t MAX_HANDLES = 1u << 21;
+
+                /** The handle of the cluster, or UINT32_MAX if the pool is full. */
+                uint32_t intern(uint8_t const* text, size_t length);
+                ByteSpan text(uint32_t handle) const { return ByteSpan{mBytes.data() + mOffsets[handle], size_t(mOffsets[handle + 1] - mOffsets[handle])}; }
+                size_t size() const { return mOffsets.size() - 1; }
+                /** Keep only the clusters whose entry in remap is not UINT32_MAX, and replace the entries with their new handles. */
+                void compact(std::vector<uint32_t>& remap);
+        private:
+                std::vector<uint8_t> mBytes;
+                /** Where each cluster starts in mBytes, followed by the end of the last one. */
+                std::vector<uint32_t> mOffsets = std::vector<uint32_t>(1, 0);
+                InternSlots mSlots;
+
+                void rehash(size_t count);
+};
+
+/** A single character cell of the screen, packed into 8 bytes so that screen buffers are compact and cells are compared
+ * as a single word. It holds a code point, or the handle of a cluster in the GraphemePool, together with its width and
+ * the index of its style in the StyleTable. A wide character takes up two cells, where the second one is a WIDE_CONTINUATION. */
+class Cell {
+        public:
+                /** The right half of the wide character in the cell to the left. */
+                static const uint32_t WIDE_CONTINUATION = 0x110000;
+                /** What is in a cell of the front buffer when it is not known what the terminal shows there. */
+                static const uint32_t UNKNOWN = 0x110001;
+                /** What codepoint() is for a grapheme cluster of several code points. */
+                static const uint32_t GRAPHEME = 0x110002;
+
+                Cell() = default;
+                Cell(uint32_t codepoint, uint32_t style, unsigned int width = 1) : mGlyph(codepoint | (width << WIDTH_SHIFT)), mStyle(style) {}
+                static Cell grapheme(uint32_t handle, uint32_t style, unsigned int width) { return Cell(handle | GRAPHEME_FLAG, style, width); }
+
+                uint32_t codepoint() const { return (mGlyph & GRAPHEME_FLAG) ? GRAPHEME : (mGlyph & VALUE_MASK); }
+                bool isGrapheme() const { return (mGlyph & GRAPHEME_FLAG) != 0; }
+                uint32_t graphemeHandle() const { return mGlyph & VALUE_MASK; }
+                /** The number of columns the character takes up, which is 0 for a WIDE_CONTINUATION. */
+                unsigned int width() const { return (mGlyph >> WIDTH_SHIFT) & 3; }
+                uint32_t style() const { return mStyle; }
+                /** The same cell with the style and grapheme handle replaced by their entries in the remap tables. */
+                Cell remapped(std::vector<uint32_t> const& styles, std::vector<uint32_t> const& graphemes) const {
+                        Cell cell = *this;
+                        cell.mStyle = styles[mStyle];
+                        if (isGrapheme()) cell.mGlyph = (mGlyph & ~VALUE_MASK) | graphemes[graphemeHandle()];
+                        return cell;
+                }
+
+                uint64_t word() const { return mGlyph | (uint64_t(mStyle) << 32); }
+                bool operator==(Cell const& other) const { return mGlyph == other.mGlyph && mStyle == other.mStyle; }
+                bool operator!=(Cell const& other) const { return !(*this == other); }
+        private:
+                static const uint32_t VALUE_MASK = (1u << 21) - 1;
+                static const unsigned int WIDTH_SHIFT = 21;
+                static const uint32_t GRAPHEME_FLAG = 1u << 23;
+
+                uint32_t mGlyph{' ' | (1u << WIDTH_SHIFT)};
+                uint32_t mStyle{0};
+};
+static_assert(sizeof(Cell) == 8, "Cell should be packed into 8 bytes");
+
+/** A row-major grid of cells in one contiguous array. Unlike the public Terminal API, row 0 is the top row. */
+class ScreenBuffer {
+        public:
+                /** Change the size, keeping the content of the top left part that is still visible. The cells are moved
+                 * within the array, which is only reallocated when it grows. */
+                void resize(Size size);
+                void fill(Cell const& cell) { std::fill(mCells.begin(), mCells.begin() + size_t(mRows) * mColumns, cell); }
+                /** Fill the rows [top, bottom) and columns [left, right) with the given cell. */
+                void fillRectangle(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, Cell const& cell);
+                /** Copy the rows [top, bottom) and columns [left, right) to have their top left corner at toTop, toLeft. The areas may overlap. */
+                void copyRectangle(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, unsigned int toTop, unsigned int toLeft);
+                /** Move the rows [top, bottom) up by the given number of lines, filling the exposed rows with blank. */
+                void scrollUp(unsigned int top, unsigned int bottom, unsigned int lines, Cell const& blank);
+                /** Move the rows [top, bottom) down by the given number of lines, filling the exposed rows with blank. */
+                void scrollDown(unsigned int top, unsigned int bottom, unsigned int lines, Cell const& blank);
+                /** Replace the halves of wide characters in the row whose other half has been overwritten with blanks, as a terminal does. */
+                void removeBrokenWideCharacters(unsigned int row);
+                /** Replace the cells outside the columns [left, right) of the rows [top, bottom) that hold half of a wide
+                 * character which is split by the edge, so that changing the columns would break it. */
+                void splitWideCharacters(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right, Cell const& replacement);
+
+                Cell* row(unsigned int row) { return &mCells[row * mColumns]; }
+                Cell const* row(unsigned int row) const { return &mCells[row * mColumns]; }
+                uint64_t rowHash(unsigned int row) const;
+                Cell& at(unsigned int row, unsigned int column) { return mCells[row * mColumns + column]; }
+                Cell const& at(unsigned int row, unsigned int column) const { return mCells[row * mColumns + column]; }
+                unsigned int rows() const { return mRows; }
+                unsigned int columns() const { return mColumns; }
+                Size size() const { return Size{mRows, mColumns}; }
+        private:
+                /** May be larger than needed after shrinking. */
+                std::vector<Cell> mCells;
+                unsigned int mRows{0};
+                unsigned int mColumns{0};
+};
+
+/** What has changed in each row of a screen buffer, as the columns [left, right) that cover all changes to the row.
+ * Keeping one span per row is cheap enough to do for every character drawn, and as tight as a list of rectangles for
+ * the text and boxes that are drawn in practice. */
+class Damage {
+        public:
+                /** Forget all damage and track the given number of rows. */
+                void reset(unsigned int rows) { mSpans.assign(rows, Span{UINT32_MAX, 0}); mTop = rows; mBottom = 0; }
+                /** Add the rows [top, bottom) and columns [left, right). */
+                void add(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right);
+                void clear();
+                /** All damaged rows are in [top(), bottom()), which is empty when there is no damage. */
+                unsigned int top() const { return mTop; }
+                unsigned int bottom() const { return mBottom; }
+                /** The damaged columns of a row, where left >= right if it has none. */
+                unsigned int left(unsigned int row) const { return mSpans[row].left; }
+                unsigned int right(unsigned int row) const { return mSpans[row].right; }
+        private:
+                struct Span { unsigned int left, right; };
+                std::vector<Span> mSpans;
+                unsigned int mTop{0};
+                unsigned int mBottom{0};
+};
+
+class Canvas;
+
 class Terminal {
         private:
                 /** Coordinate system is 0,0 in lower left corner ranging to (cols-1, rows-1). */
                 unsigned int WARN_UNUSED flipRow(unsigned int row) const { return mRows - row; }
 	public:
+		/** A terminal on stdin and stdout. */
 		Terminal();
+		/** A terminal on the given input and output, which must outlive it. */
+		explicit Terminal(TerminalIo& io);
 		~Terminal();
 
-		void setCursorApp() { this->cursor_app_set = true; print("\033[?1h"); }
-		void setKeypadApp() { this->keypad_app_set = true; print("\033[66?h"); }
-
-                void setBracketedPasteMode(bool set) { print("\033[?2004%s", set ? "h" : "l"); this->bracketed_paste_mode = set; }
-
-                Terminal& enterAltScreen() { alt_screen_set = true; decPrivateMode(1049, true); return *this; }
-                Terminal& leaveAltScreen() { alt_screen_set = false; decPrivateMode(1049, false); return *this;  }
-
-                /** Discard the latest event and read another one. Does not need to read from the terminal if buffered. */
-                EventType await();
-
-                Terminal& sleep(unsigned int milliseconds) { usleep(milliseconds * 1000); return *this; }
-                Terminal& clear() { print("\033[2J"); /* ED – Erase In Display */; return *this; }
-
-                Terminal& setBackground(Color color) { print("\033[%dm", 40 + int(color)); return *this; }
-                Terminal& setForeground(Color color) { print("\033[%dm", 30 + int(color)); return *this; }
-                Terminal& resetColorsAndStyle() { print("\033[0m"); return *this; }
+		void setCursorApp() { this->cursor_app_set = true; emit<Csi::DECSET>(1); }
+		void setKeypadApp() { this->keypad_app_set = true; emit<Csi::DECSET>(66); }
+
+                void setBracketedPasteMode(bool set) { decPrivateMode(2004, set); this->bracketed_paste_mode = set; }
+                /** Report when the terminal gains and loses focus as FOCUS_IN and FOCUS_OUT events. */
+                Terminal& setFocusReporting(bool enabled) { decPrivateMode(1004, enabled); focus_reporting = enabled; return *this; }
+                /** How long an ESC that nothing has followed waits for the rest of an escape sequence before it is returned as
+                 * the escape key, 50 milliseconds by default. Likewise ESC [ and ESC O become alt+[ and alt+O, as
+                 * does ESC P while probeCapabilities() waits for replies. */
+                Terminal& setEscapeTimeout(unsigned int milliseconds) { mEscapeTimeoutMilliseconds = milliseconds; return *this; }
+
+                Terminal& enterAltScreen() { present(); alt_screen_set = true; decPrivateMode(1049, true); resetScreenModel(true); return *this; }
+                Terminal& leaveAltScreen() { present(); alt_screen_set = false; decPrivateMode(1049, false); resetScreenModel(false); return *this;  }
+
+                /** In retained mode drawing calls only update an off-screen buffer, which is sent to the terminal by present().
+                 * The screen is assumed to be blank when entering retained mode - use clear() to make sure it is. Once
+                 * something has been presented clear() only clears the buffer, so it is cheap to clear and redraw a frame. */
+                Terminal& setRetainedMode(bool retained);
+                bool retainedMode() const { return mRetained; }
+                /** Send the cells that has changed since the last present() to the terminal as one frame. Does nothing if not in retained mode. */
+                Terminal& present();
+                /** Forget what the terminal shows, so that the next present() clears it and sends every cell. */
+                Terminal& repaint();
+                /** Reset the style of the terminal and forget where its cursor is, so that the next present() moves it with
+                 * an absolute position. Needed when output from something else may have been sent since the last present(). */
+                Terminal& forgetCursorAndStyle();
+                /** Draw on the canvas instead of the screen, until drawOn(nullptr) or present(), with the size, cursor and
+                 * scrolling region of the canvas. Only in retained mode, since canvases are composited by present(). */
+                Terminal& drawOn(Canvas* canvas);
+                /** The canvas that is drawn on, or nullptr for the screen. */
+                Canvas* drawingOn() const { return mCanvas; }
+                /** If the last present() had anything to send. */
+                bool lastPresentChanged() const { return mLastPresentChanged; }
+                /** Wrap the output of each present() in synchronized update mode (DEC private mode 2026), so that
+                 * terminals supporting it show the whole frame at once instead of tearing while it is drawn. Left out
+                 * when Capability::SYNCHRONIZED_UPDATES is not set, such as after a probe found it missing. */
+                Terminal& setSynchronizedUpdates(bool enabled) { mSynchronizedUpdates = enabled; return *this; }
+                /** If await() and sleep() should present() before blocking, which is the default. Turn it off when
+                 * presenting is paced by something else, such as a FrameScheduler. */
+                Terminal& setAutoPresent(bool enabled) { mAutoPresent = enabled; return *this; }
+
+                /** Discard the latest event and read another one. Does not need to read from the terminal if buffered.
+                 * Returns TIMEOUT if no event arrived within the timeout, where a negative timeout means waiting forever.
+                 * Once the input has ended, such as a pipe being closed, or reading it has failed, the events still
+                 * buffered are returned followed by INPUT_ENDED, which every later call returns at once. */
+                EventType await(int timeoutMilliseconds = -1);
+                /** Like await(), but with the timeout given as a deadline in monotonicNanos() time. */
+                EventType awaitUntil(uint64_t deadline);
+                /** Wait like await() for an event, and then parse all events that are available without blocking into
+                 * events, up to capacity. Consecutive mouse motion is merged into the latest position. Returns the number
+                 * of events, which is 0 on timeout. An INPUT_ENDED event is the last one. */
+                size_t awaitBatch(Event* events, size_t capacity, int timeoutMilliseconds = -1);
+                /** The event returned by the last await(). */
+                Event const& lastEvent() const { return mEvent; }
+                /** The time of a clock that is not affected by changes to the system time, in nanoseconds. */
+                static uint64_t monotonicNanos();
+                /** When await() has something to do even if no input arrives, which is to return an ESC that nothing has
+                 * followed as the escape key or to give up waiting for the replies to a probe, or UINT64_MAX if nothing.
+                 * For when something else waits for the input and calls awaitUntil(0) when it arrives, which should also
+                 * be done at this time. */
+                uint64_t nextDeadline() const {
+                        uint64_t deadline = (escapeTimeoutPending() && mEscapeDeadline != 0) ? mEscapeDeadline : UINT64_MAX;
+                        return (mProbeDeadline != 0 && mProbeDeadline < deadline) ? mProbeDeadline : deadline;
+                }
+                /** Ask the TerminalIo for the size and resize if it has changed, returning if it had. await() does this when the
+                 * TerminalIo reports a resize, so this is only needed when something else reads the input. */
+                bool updateSize() { return checkResize(); }
+
+                /** The counters of what the terminal has done, which all stay zero unless built with SCREENCANVAS_STATS=1. */
+                TerminalStats const& stats() const;
+                /** When built with SCREENCANVAS_STATS=1, write stats() to the file descriptor when destroyed, or not if -1. By default
+                 * they are written to the file named by the SCREENCANVAS_STATS_FILE environment variable, if set. */
+                Terminal& setStatsDumpFd(int fd);
+
+                /** If runs of printable characters should be returned as a single TEXT event instead of one CHAR event each.
+                 * Control characters such as enter, tab and backspace are still CHAR events. */
+                Terminal& setTextRuns(bool enabled) { mTextRuns = enabled; return *this; }
+                /** The UTF-8 text of the last TEXT event. Only valid until the next call to await(). */
+                ByteSpan lastText() const { return mEvent.text; }
+
+                /** The pasted text of the last PASTE event. Requires setBracketedPasteMode(true). Pasted text is streamed in
+                 * chunks as it arrives, so a large paste results in several PASTE events of which the last has pasteFinished()
+                 * set. Only valid until the next call to await(), so copy it if the whole paste is needed at once. */
+                ByteSpan lastPaste() const { return mEvent.text; }
+                bool pasteFinished() const { return mEvent.pasteFinished; }
+
+                Terminal& sleep(unsigned int milliseconds) { if (mAutoPresent) present(); flush(); usleep(milliseconds * 1000); return *this; }
+
+                /** Output is buffered until flush() is called, a frame ends or the terminal is waited on by await() or sleep(). */
+                Terminal& flush();
+                /** Start a frame, during which nothing is written until the matching endFrame(). Frames may be nested. */
+                Terminal& beginFrame() { mFrameDepth++; return *this; }
+                /** End a frame and write all its output at once if it was the outermost one. */
+                Terminal& endFrame() { if (mFrameDepth > 0 && --mFrameDepth == 0) flush(); return *this; }
+                Terminal& clear();
+
+                /** Colors and attributes only change what is drawn next. The terminal is sent a single combined SGR
+                 * sequence when something is drawn with a style that differs from the one it has. */
+                Terminal& setBackground(Color color) { return setStyle(mStyle.withBackground(Style::basicColor(color))); }
+                Terminal& setForeground(Color color) { return setStyle(mStyle.withForeground(Style::basicColor(color))); }
+                /** Use a color from the 256 color palette. */
+                Terminal& setBackgroundIndexed(uint8_t index) { return setStyle(mStyle.withBackground(Style::indexedColor(index))); }
+                Terminal& setForegroundIndexed(uint8_t index) { return setStyle(mStyle.withForeground(Style::indexedColor(index))); }
+                /** Use a 24-bit color, which is sent as the closest palette color unless Capability::TRUE_COLOR is set. */
+                Terminal& setBackgroundRgb(uint8_t red, uint8_t green, uint8_t blue) { return setStyle(mStyle.withBackground(Style::rgbColor(red, green, blue))); }
+                Terminal& setForegroundRgb(uint8_t red, uint8_t green, uint8_t blue) { return setStyle(mStyle.withForeground(Style::rgbColor(red, green, blue))); }
+                Terminal& setAttribute(Attribute attribute, bool set) { return setStyle(mStyle.withAttribute(attribute, set)); }
+                Terminal& setStyle(Style style) { if (style != mStyle) { mStyle = style; mStyleIndex = UINT32_MAX; } return *this; }
+                Style style() const { return mStyle; }
+                Terminal& resetColorsAndStyle() { return setStyle(Style()); }
                 Terminal& setTitle(char const* fmt, ...);
 
                 Terminal& showCursor() { cursor_hidden = false; decPrivateMode(25, true); return *this; }
                 Terminal& hideCursor() { cursor_hidden = true; decPrivateMode(25, false); return *this; }
-		Terminal& placeCursor(unsigned int x, unsigned int y) { print("\033[%u;%uH", flipRow(y), x + 1); return *this; }
-		Terminal& placeCursorAtColumn(unsigned int x) { print("\033[%uG", x + 1); return *this; }
+		Terminal& placeCursor(unsigned int x, unsigned int y);
+		Terminal& placeCursorAtColumn(unsigned int x);
                 Terminal& moveCursor(int right, int up);
 
-                Terminal& erase(unsigned int chars) { print("\033[%dX", chars); return *this; }
+                Terminal& erase(unsigned int chars);
 
-                Terminal& setCursorStyleBlock() { print("\033[2 q"); return *this; }
-                Terminal& setCursorStyleUnderline() { print("\033[4 q"); return *this; }
-                Terminal& setCursorStyleBar() { print("\033[6 q"); return *this; }
+                Terminal& setCursorStyleBlock() { emit<Csi::DECSCUSR>(2); return *this; }
+                Terminal& setCursorStyleUnderline() { emit<Csi::DECSCUSR>(4); return *this; }
+                Terminal& setCursorStyleBar() { emit<Csi::DECSCUSR>(6); return *this; }
 
-                Terminal& enableMouse() { mouse_enabled = true; decPrivateMode(1000, true); decPrivateMode(1006, true); return *this; }
-                Terminal& disableMouse() { mouse_enabled = false; decPrivateMode(1000, false); decPrivateMode(1006, false); return *this; }
+                Terminal& enableMouse(MouseTracking tracking = MouseTracking::CLICKS) {
+                        if (mouse_enabled) disableMouse();
+                        mouse_enabled = true;
+                        mMouseTracking = tracking;
+                        decPrivateMode(mouseTrackingMode(), true);
+                        decPrivateMode(1006, true);
+                        return *this;
+                }
+                Terminal& disableMouse() { mouse_enabled = false; decPrivateMode(mouseTrackingMode(), false); decPrivateMode(1006, false); return *this; }
 
-                Terminal& insertLines(unsigned int lines) { print("\033[%dL", lines); return *this; }
-                Terminal& deleteLines(unsigned int lines) { print("\033[%dM", lines); return *this; }
-                Terminal& deleteCells(unsigned int cells) { print("\033[%dP", cells); return *this; }
+                Terminal& insertLines(unsigned int lines);
+                Terminal& deleteLines(unsigned int lines);
+                Terminal& deleteCells(unsigned int cells);
 
-                Terminal& setWrapAround(bool wrap) { decPrivateMode(7, wrap); return *this; }
+                Terminal& setWrapAround(bool wrap) { mWrapAround = wrap; decPrivateMode(7, wrap); return *this; }
 
-                Terminal& setMargins(unsigned int top, unsigned int bottom) { print("\033[%d;%dr", top, bottom); return *this; }
+                Terminal& setMargins(unsigned int top, unsigned int bottom);
 
+                /** Print text at the cursor. In retained mode the text goes into the screen buffer, one cell per grapheme
+                 * cluster and two for wide ones, which wrap to the next line as a whole if they do not fit. */
                 Terminal& print(char const* fmt, ...);
+                /** Like print(), but only the grapheme clusters that fit in maxWidth columns. In retained mode the text is
+                 * also cut at the end of the line instead of wrapping. Meant for text without line breaks, such as table cells. */
+                Terminal& printClipped(unsigned int maxWidth, char const* fmt, ...);
                 uint32_t columns() const { return mColumns; }
                 uint32_t rows() const { return mRows; }
+                Size size() const { return Size{mRows, mColumns}; }
 
-                bool modifierControl() const { return (mLastModifierKeys & (1 << int(ModifierKey::CTRL))) != 0; }
-                bool modifierShift() const { return (mLastModifierKeys & (1 << int(ModifierKey::SHIFT))) != 0; }
+                bool modifierControl() const { return (mEvent.modifiers & (1 << int(ModifierKey::CTRL))) != 0; }
+                bool modifierShift() const { return (mEvent.modifiers & (1 << int(ModifierKey::SHIFT))) != 0; }
+                bool modifierAlt() const { return (mEvent.modifiers & (1 << int(ModifierKey::ALT))) != 0; }
+                bool modifierMeta() const { return (mEvent.modifiers & (1 << int(ModifierKey::META))) != 0; }
 
+                /** Fill with a character that takes up a single column. */
                 void fillRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, uint32_t codepoint);
-                uint32_t lastCharacter() const { return mLastCharacter; }
-                Key lastKey() const { return mLastKey; }
-
-                unsigned int lastMouseRow() const { return mLastMouseRow; }
-                unsigned int lastMouseColumn() const { return mLastMouseColumn; }
+                /** Copy the given number of columns and rows with the bottom left corner at column, row to have its bottom
+                 * left corner at toColumn, toRow. In retained mode present() sends this as a single DECCRA when the
+                 * terminal supports it and the content is still there, which makes moving a pane cheap. In immediate
+                 * mode it requires Capability::RECTANGULAR_EDITING, since the screen cannot be read back. */
+                Terminal& copyRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, unsigned int toColumn, unsigned int toRow);
+
+                /** Tell which optional features the terminal supports. BACKGROUND_COLOR_ERASE is assumed by default, as it is
+                 * by everything xterm compatible, and SYNCHRONIZED_UPDATES since terminals without it ignore it, while the
+                 * others are missing from many terminals. probeCapabilities() finds out instead. */
+                Terminal& setCapability(Capability capability, bool supported) {
+                        if (supported) mCapabilities |= 1u << int(capability); else mCapabilities &= ~(1u << int(capability));
+                        return *this;
+                }
+                bool hasCapability(Capability capability) const { return (mCapabilities & (1u << int(capability))) != 0; }
+                /** All capabilities as a bit mask of (1 << Capability), such as to give another Terminal on the same terminal. */
+                uint32_t capabilities() const { return mCapabilities; }
+                Terminal& setCapabilities(uint32_t capabilities) { mCapabilities = capabilities; return *this; }
+                /** Ask the terminal what it supports with DA1, DA2, DECRQM and XTVERSION, without waiting for the replies.
+                 * They are parsed by await(), which returns a CAPABILITIES event once the capabilities are set from them,
+                 * or when timeoutMilliseconds have passed with what has been confirmed by then, and again if the replies
+                 * come after all. Once all replies have come, the result is cached on disk by CapabilityCache if useCache
+                 * is set and the TerminalIo tells the environment of the terminal, so that later probes in the same kind of
+                 * terminal set the capabilities at once and the next await() returns the event without asking. */
+                Terminal& probeCapabilities(unsigned int timeoutMilliseconds = 1000, bool useCache = true);
+                /** If probeCapabilities() has finished, from replies, the cache or a timeout. */
+                bool capabilitiesProbed() const { return mCapabilitiesProbed; }
+                /** The reply to XTVERSION, such as "xterm(388)", or empty if not known. */
+                std::string const& terminalVersion() const { return mTerminalVersion; }
+                /** Ask the terminal where its cursor is with DSR 6, which await() returns as a CURSOR_POSITION event. A reply
+                 * for the first row is the same as ctrl+F3 and the like, so such replies are only recognized while asking. */
+                Terminal& requestCursorPosition() { mCursorPositionRequests++; return emit<Csi::DSR>(6); }
+                uint32_t lastCharacter() const { return mEvent.character; }
+                Key lastKey() const { return mEvent.key; }
+
+                unsigned int lastMouseRow() const { return mEvent.row; }
+                unsigned int lastMouseColumn() const { return mEvent.column; }
+                uint8_t lastMouseButton() const { return mEvent.mouseButton; }
 
         private:
-                uint8_t mReadBuffer[32];
+                friend class Canvas;
+
+                /** Also holds pasted text, so large enough to deliver big chunks of it at a time. */
+                std::vector<uint8_t> mReadBuffer = std::vector<uint8_t>(64 * 1024);
                 unsigned int mReadBufferLength{0};
                 unsigned int mReadBufferOffset{0};
+                /** If what is left in the read buffer cannot be processed until more has been read. */
+                bool mInputIncomplete{false};
                 uint8_t mUtf8Buffer[4];
                 unsigned int mUtf8Index{0};
-                unsigned int mUtf8Remaining{0};
-                bool const is_tty{!!isatty(0)};
-		struct termios vt_orig;
+                bool mTextRuns{false};
+                /** If between the start and end markers of a bracketed paste. */
+                bool mPasting{false};
+                /** If reading has returned the end of the input or failed, and the errno of the failure. */
+                bool mInputEnded{false};
+                int mInputError{0};
+                /** If spans into the read buffer have been returned by awaitBatch(), so that it must not be moved. */
+                bool mSpansHandedOut{false};
+                /** Where input is read from and output written to. */
+                TerminalIo& mIo;
+#if SCREENCANVAS_STATS
+                TerminalStats mStats;
+                /** Where to dump mStats when destroyed, or -1, and if it was opened by the Terminal. */
+                int mStatsDumpFd{-1};
+                bool mStatsDumpFdOwned{false};
+                /** When the input being parsed was read, and when the earliest input that no present() has followed was. */
+                uint64_t mInputReadTime{0};
+                uint64_t mUnpresentedInputTime{0};
+#endif
 		bool cursor_app_set{false};
 		bool keypad_app_set{false};
                 bool bracketed_paste_mode{false};
                 bool alt_screen_set{false};
                 bool mouse_enabled{false};
+                bool focus_reporting{false};
+                MouseTracking mMouseTracking{MouseTracking::CLICKS};
                 bool cursor_hidden{false};
 
                 uint32_t mRows{0};
                 uint32_t mColumns{0};
 
-                Key mLastKey{Key::UP};
-                uint32_t mLastModifierKeys{0};
-                EventType mLastEventType{EventType::NONE};
-                uint32_t mLastCharacter{0};
-
-                static const unsigned int MAX_ESCAPE_ARGS = 32;
-                static const unsigned int MAX_ESCAPE_ARG_LENGTH = 128;
-                char mEscapeArguments[MAX_ESCAPE_ARGS][MAX_ESCAPE_ARG_LENGTH];
-                unsigned int mCurrentEscapeArg{0};
-                unsigned int mCurrentEscapeArgLengths[MAX_ESCAPE_ARGS]{0};
-                unsigned int mLastMouseRow;
-                unsigned int mLastMouseColumn;
-
-                EscapeState mEscapeState{EscapeState::NONE};
+                Event mEvent;
+
+                /** The numeric parameters of the escape sequence being parsed, accumulated a digit at a time. A parameter is
+                 * zeroed when it starts and only the count is reset for a new sequence, so nothing needs to be cleared. */
+                static const unsigned int MAX_ESCAPE_PARAMS = 16;
+                /** The largest code point, which is the largest value a parameter such as the key of CSI u needs. */
+                static const uint32_t MAX_ESCAPE_PARAM_VALUE = 0x10FFFF;
+                uint32_t mEscapeParams[MAX_ESCAPE_PARAMS];
+                unsigned int mEscapeParamCount{0};
+                /** The private marker, such as '<' for SGR mouse reports, and the last intermediate byte of the sequence, or 0. */
+                uint8_t mEscapePrivate{0};
+                uint8_t mEscapeIntermediate{0};
+                /** Modifiers of the event that the sequence ends with, which is ALT if it was preceded by an extra ESC. */
+                uint8_t mEscapeModifiers{0};
+                /** The start of the DCS string being parsed, and the length of all of it. The rest of a string longer than
+                 * MAX_DCS_LENGTH, which cannot be a reply, is skipped up to its ST in DCS_IGNORE. */
+                static const unsigned int MAX_DCS_KEPT = 64;
+                static const unsigned int MAX_DCS_LENGTH = 1024;
+                char mDcs[MAX_DCS_KEPT];
+                unsigned int mDcsLength{0};
+                /** Why the sequence skipped in CSI_IGNORE could not be parsed. */
+                ParseError mIgnoredError{ParseError::UNKNOWN_ESCAPE};
+                EscapeState mEscapeState{EscapeState::GROUND};
+                /** When an ESC that nothing has followed is taken to be the escape key, or 0 if not waiting for that. */
+                uint64_t mEscapeDeadline{0};
+                unsigned int mEscapeTimeoutMilliseconds{50};
+
+                OutputBuffer mOutput;
+                unsigned int mFrameDepth{0};
+                /** Outside of a frame, output is written out when this much has been buffered. */
+                static const size_t OUTPUT_HIGH_WATER = 64 * 1024;
+
+                bool mRetained{false};
+                bool mAutoPresent{true};
+                bool mSynchronizedUpdates{false};
+                bool mLastPresentChanged{false};
+                /** What is believed to be on the screen, and what should be there after the next present(). */
+                ScreenBuffer mFrontBuffer;
+                ScreenBuffer mBackBuffer;
+                /** Set when the screen content is unknown, so that the next present() should clear it first. */
+                bool mClearPending{false};
+                /** If the front buffer is known to match the screen, rather than being assumed blank. */
+                bool mFrontBufferKnown{false};
+                /** The cursor in the back buffer, with row 0 at the top. */
+                unsigned int mCursorRow{0};
+                unsigned int mCursorColumn{0};
+                /** If the cursor is in the last column and the next printed character should wrap to the next line. */
+                bool mWrapPending{false};
+                bool mWrapAround{true};
+                /** The scrolling region as the rows [mMarginTop, mMarginBottom) in the back buffer. */
+                unsigned int mMarginTop{0};
+                unsigned int mMarginBottom{0};
+                /** The style that is drawn with, and its index in mStyles or UINT32_MAX if not interned since it changed. */
+                Style mStyle;
+                uint32_t mStyleIndex{0};
+                /** What the cells of the screen buffers refer to, compacted by present() when mostly unused. */
+                StyleTable mStyles;
+                GraphemePool mGraphemes;
+                /** The number of styles and grapheme clusters in use after the last compaction. */
+                size_t mLiveStyles{1};
+                size_t mLiveGraphemes{0};
+                /** Kept to avoid allocating in compactPools(). */
+                std::vector<uint32_t> mStyleRemap;
+                std::vector<uint32_t> mGraphemeRemap;
+                /** The cursor position of the terminal while presenting, UINT32_MAX if unknown, and the style it has. */
+                unsigned int mPresentedRow{UINT32_MAX};
+                unsigned int mPresentedColumn{UINT32_MAX};
+                Style mPresentedStyle;
+                /** Row hashes of the front and back buffers, kept to avoid allocating in presentScrolls(). */
+                std::vector<uint64_t> mFrontRowHashes;
+                std::vector<uint64_t> mBackRowHashes;
+                /** Pairs of row hash and row index of the front buffer, sorted for lookup by hash. */
+                std::vector<std::pair<uint64_t, unsigned int>> mFrontRowsByHash;
+                /** Bit mask of (1 << Capability). */
+                uint32_t mCapabilities{(1u << int(Capability::BACKGROUND_COLOR_ERASE)) | (1u << int(Capability::SYNCHRONIZED_UPDATES))};
+                /** The capabilities that probeCapabilities() sets or clears, which are cached. */
+                static const uint32_t PROBED_CAPABILITIES = (1u << int(Capability::REPEAT)) | (1u << int(Capability::RECTANGULAR_EDITING))
+                                | (1u << int(Capability::TRUE_COLOR)) | (1u << int(Capability::SYNCHRONIZED_UPDATES))
+                                | (1u << int(Capability::BRACKETED_PASTE)) | (1u << int(Capability::SGR_MOUSE));
+                /** While a probe waits for replies, when it gives up, or 0, and what the replies have confirmed so far. */
+                uint64_t mProbeDeadline{0};
+                uint32_t mConfirmedCapabilities{0};
+                /** Until the reply to DA1, which terminals send after those to the other queries, ESC P starts a DCS reply. */
+                bool mProbeRepliesPending{false};
+                /** If the next await() should return CAPABILITIES, as when the probe was answered by the cache. */
+                bool mProbeEventPending{false};
+                bool mCapabilitiesProbed{false};
+                /** The replies to requestCursorPosition() that have not come yet. */
+                unsigned int mCursorPositionRequests{0};
+                /** The key of the terminal in the CapabilityCache, or empty if the result should not be cached. */
+                std::string mProbeCacheKey;
+                std::string mTerminalVersion;
+                /** A copyRectangle() in retained mode, with rows from the top, to try as a DECCRA in present(). */
+                struct CopyHint { unsigned int top, left, bottom, right, toTop, toLeft; };
+                std::vector<CopyHint> mCopyHints;
+                /** More copies than this in a frame are only drawn as cells. */
+                static const size_t MAX_COPY_HINTS = 64;
+                /** The canvases in the order they are composited, the one being drawn on if any, and where drawing records what
+                 * it changes: in the canvas drawn on, in mScreenDamage when there are canvases to composite, or nowhere. */
+                std::vector<Canvas*> mCanvases;
+                Canvas* mCanvas{nullptr};
+                Damage* mDamage{nullptr};
+                Damage mScreenDamage;
+                /** The back buffer with the canvases composited over it, kept between frames so that only damage is composited again. */
+                ScreenBuffer mComposedBuffer;
+                /** Orders canvases with the same z by when they were created or raised. */
+                uint64_t mCanvasSequence{0};
 
                 void clipToScreen(unsigned int& row, unsigned int col) const {  row = flipRow(row); if (row >= mRows) row = mRows - 1; if (col >= mColumns) col = mColumns - 1; }
-                void escapeError(char const* fmt, ...) { 
-                        va_list argp;
-                        va_start(argp, fmt);
-                        vfprintf(stderr, fmt, argp); 
-                        va_end(argp);
-                        fflush(stderr);
-                        escapeDone();
-                };
-
-                void escapeDone() {
-                        mEscapeState = EscapeState::NONE;
-                        mCurrentEscapeArg = 0;
-                        memset(mEscapeArguments, 0, sizeof(mEscapeArguments));
-                        memset(mCurrentEscapeArgLengths, 0, sizeof(mCurrentEscapeArgLengths));
-                }
-
-                void processByte(uint8_t byte);
-
-                void addEscapeArg(uint8_t byte) { 
-                        if (byte == ';') {
-                                if (mCurrentEscapeArg + 1 == MAX_ESCAPE_ARGS) {
-                                        escapeError("Too man escape args");
-                                } else {
-                                        mCurrentEscapeArg++;
-                                }
-                        } else {
-                                unsigned int& len = mCurrentEscapeArgLengths[mCurrentEscapeArg];
-                                if (len + 1 == MAX_ESCAPE_ARG_LENGTH) {
-                                        escapeError("Too larg escape sequence");
-                                } else {
-                                        mEscapeArguments[mCurrentEscapeArg][len++] = byte;
-                                }
-                        }
+                /** Skip the escape sequence that could not be parsed. */
+                void escapeError(ParseError error) {
+                        IF_STATS(mStats.parseErrors[size_t(error)]++);
+                        (void) error;
+                        mEscapeState = EscapeState::GROUND;
+                        mEscapeModifiers = 0;
                 }
-
-                int argAsNumber(unsigned int index) {
-                        if (index > mCurrentEscapeArg) {
-                                perror("argAsNumber ERROR");
-                                _exit(1);
-                        }
-                        mEscapeArguments[index][mCurrentEscapeArgLengths[index]] = 0;
-                        return atol(mEscapeArguments[index]);
+                /** A parameter of the escape sequence, where one that was not given is 0. */
+                uint32_t escapeParam(unsigned int index) const { return index < mEscapeParamCount ? mEscapeParams[index] : 0; }
+
+                /** Process one byte of input, returning false if it should be processed again after the produced event. */
+                bool processByte(uint8_t byte);
+                /** Process a byte of a UTF-8 encoded character. */
+                bool processUtf8(uint8_t byte);
+                /** Produce the event of a complete CSI or SS3 sequence ending with the final byte. */
+                void dispatchCsi(uint8_t final);
+                void dispatchSs3(uint8_t final);
+                /** Take in a reply to a probe query, returning false if the sequence is not one. */
+                bool dispatchProbeReply(uint8_t final);
+                void dispatchDcs();
+                /** Set the capabilities from the replies, and from the cache or into it, producing a CAPABILITIES event. */
+                void finishProbe(bool answered);
+                void characterEvent(uint32_t character, uint32_t modifierParam = 0);
+                /** Produce a KEY event, with the modifiers of an xterm modifier parameter if not 0. */
+                void keyEvent(Key key, uint32_t modifierParam);
+                /** If the parser holds an ESC, ESC [, ESC O or ESC P that is returned as a key if nothing follows it in time. */
+                bool escapeTimeoutPending() const {
+                        return !mPasting && mUtf8Index == 0 && (mEscapeState == EscapeState::ESCAPE || mEscapeState == EscapeState::CSI_ENTRY
+                                        || (mEscapeState == EscapeState::SS3 && mEscapeParamCount == 0)
+                                        || (mEscapeState == EscapeState::DCS_STRING && mDcsLength == 0));
                 }
+                void escapeTimedOut();
+                /** Read the next event into mEvent, returning false on timeout. */
+                bool readEvent(uint64_t deadline);
+                /** Produce the event that is left once the input has ended, ending with INPUT_ENDED. */
+                void inputEnded();
+                /** The DEC private mode for mMouseTracking: X11 mouse, button event or any event tracking. */
+                unsigned int mouseTrackingMode() const { return mMouseTracking == MouseTracking::CLICKS ? 1000 : (mMouseTracking == MouseTracking::DRAG ? 1002 : 1003); }
+                /** Check if the size has changed after the TerminalIo reported a possible resize, in which case it is updated. */
+                bool checkResize();
+                /** Deliver the pasted text at the start of the read buffer, returning how many bytes that was consumed. */
+                unsigned int processPaste();
 
 		void decPrivateMode(unsigned int mode, bool set) {
-			printf("\033[?%u%c", mode, (set ? 'h' : 'l'));
-			fflush(stdout);
+			if (set) emit<Csi::DECSET>(mode); else emit<Csi::DECRST>(mode);
 		}
+
+                /** Output a control sequence directly to the terminal, bypassing the screen buffer in retained mode. */
+                template <typename Sequence, typename... Params>
+                Terminal& emit(Params... params) { mOutput.appendSequence<Sequence>(params...); outputWritten(); return *this; }
+                /** Output a fixed string directly to the terminal. */
+                template <size_t N>
+                Terminal& emit(char const (&sequence)[N]) { mOutput.append(sequence, N - 1); outputWritten(); return *this; }
+                /** Flush if outside of a frame and enough output has been buffered. */
+                void outputWritten() { if (mFrameDepth == 0 && mOutput.size() >= OUTPUT_HIGH_WATER) flush(); }
+
+                /** What erasing gives: the current background, but otherwise default colors and no attributes. */
+                Cell blankCell() { return Cell(' ', mStyles.intern(Style().withBackground(mStyle.background()))); }
+                uint32_t styleIndex() { if (mStyleIndex == UINT32_MAX) mStyleIndex = mStyles.intern(mStyle); return mStyleIndex; }
+                Style const& cellStyle(Cell const& cell) const { return mStyles[cell.style()]; }
+                /** The number of bytes of UTF-8 the character of the cell is sent as. */
+                size_t glyphLength(Cell const& cell) const { return cell.isGrapheme() ? mGraphemes.text(cell.graphemeHandle()).length : utf8Length(cell.codepoint()); }
+                /** Drop the styles and grapheme clusters that no cell refers to any more. */
+                void compactPools();
+                void resetScreenModel(bool screenBlank);
+                void resizeScreenModel();
+                /** Record that the rows [top, bottom) and columns [left, right) of what is drawn on have changed. */
+                void damage(unsigned int top, unsigned int left, unsigned int bottom, unsigned int right) { if (mDamage != nullptr) mDamage->add(top, left, bottom, right); }
+                /** The size of the screen, also while drawing on a canvas. */
+                Size screenSize() const;
+                void updateDamageTarget() { if (mCanvas == nullptr) mDamage = mCanvases.empty() ? nullptr : &mScreenDamage; }
+                /** Exchange the buffer, size, cursor and scrolling region of what is drawn on with those kept by the canvas. */
+                void swapDrawTarget(Canvas& canvas);
+                void addCanvas(Canvas* canvas);
+                void removeCanvas(Canvas* canvas);
+                void sortCanvases();
+                /** Damage the screen where the rows [top, bottom) and columns [left, right) of the canvas are shown. */
+                void damageCanvas(Canvas const& canvas, unsigned int top, unsigned int left, unsigned int bottom, unsigned int right);
+                /** Try to present a move of the canvas from having its top left corner at top, left of the screen as a copy. */
+                void hintCanvasMove(Canvas const& canvas, int64_t top, int64_t left);
+                /** Composite the damaged parts of the back buffer and the canvases into mComposedBuffer, giving the rows
+                 * [top, bottom) that cover all that was composited. */
+                void composite(unsigned int& top, unsigned int& bottom);
+                /** Format and print the text, clipped to maxWidth columns and the end of the line if clip is set. */
+                void printFormatted(bool clip, unsigned int maxWidth, char const* fmt, va_list argp);
+                void putText(char const* text, size_t length);
+                /** Put a character at the cursor and advance it, wrapping first if a wide character does not fit. */
+                void putCharacter(Cell const& cell);
+                void putControl(uint32_t codepoint);
+                void lineFeed();
+                void moveRealCursor(unsigned int row, unsigned int column);
+                /** Scroll parts of the screen to where they have moved in the back buffer before presenting cells, looking only
+                 * at the rows [changedTop, changedBottom) outside of which the back buffer equals the front buffer. */
+                void presentScrolls(unsigned int changedTop, unsigned int changedBottom);
+                void hashFrontRows(unsigned int top, unsigned int bottom);
+                /** Scroll the rows [top, bottom) of the screen and the front buffer up by lines, or down if negative. */
+                void scrollRealRegion(unsigned int top, unsigned int bottom, int lines);
+                /** The minimum number of cells that must be saved from repainting for scrolling to be worth it. */
+                static const unsigned int SCROLL_MINIMUM_SAVINGS = 16;
+                /** Send DECCRA for the copy hints that still describe how the front buffer becomes the back buffer. */
+                void presentCopies();
+                /** Send the changed cells of a row, each run of them in the cheapest supported way. */
+                void presentRow(unsigned int row, unsigned int blankRowsFrom);
+                /** Try to send the cells starting at row, column that equal the given cell as one rectangle, returning if it did. */
+                bool presentRectangle(unsigned int row, unsigned int column, unsigned int right, Cell const& cell);
+                /** The cost in bytes of sending count equal cells as literal characters, or with REP or ECH when supported. */
+                size_t runCost(Cell const& cell, unsigned int count) const;
+                bool repeatable(Cell const& cell) const;
+                bool erasable(Cell const& cell) const;
+                /** Send the SGR sequence that gives the terminal the given style, if it does not already have it. */
+                void presentStyle(Style style);
+                /** Make the terminal erase with the given background, keeping as much of the style it has as possible. */
+                void presentErasingStyle(uint32_t background) { presentStyle(mPresentedStyle.withBackground(background).withAttribute(Attribute::REVERSE, false)); }
+                void presentCell(Cell const& cell);
+};
+
+/** An off-screen region of a Terminal in retained mode, such as a pane, popup or status bar, that is drawn on with the
+ * drawing calls of the Terminal after Terminal::drawOn(&canvas), in coordinates with 0,0 in its own lower left corner.
+ * present() composites the visible canvases over what is drawn on the screen itself, in increasing z-order, but only
+ * where something has changed: each canvas keeps track of the cells drawn on it, and moving, resizing, raising, hiding
+ * or clipping a canvas only damages the area it covered and covers. Moving is also tried as a DECCRA copy of what the
+ * terminal shows, like Terminal::copyRectangle().
+ *
+ * Canvases share the styles and grapheme clusters of their Terminal, which they must not outlive. */
+class Canvas {
+        public:
+                /** A blank canvas with its lower left corner at column, row of the screen. */
+                Canvas(Terminal& terminal, int column, int row, unsigned int columns, unsigned int rows, int z = 0);
+                ~Canvas();
+                Canvas(Canvas const&) = delete;
+                Canvas& operator=(Canvas const&) = delete;
+
+                /** Put the lower left corner at column, row of the screen. The canvas may be partly or wholly off the screen. */
+                Canvas& moveTo(int column, int row);
+                /** Change the size, keeping the content of the top left part that is still inside, as a terminal does. */
+                Canvas& resize(unsigned int columns, unsigned int rows);
+                /** Canvases with a higher z are in front. Of those with the same z, the last created or raised is in front. */
+                Canvas& setZ(int z);
+                /** Put in front of the other canvases with the same z. */
+                Canvas& raise();
+                Canvas& setVisible(bool visible);
+                /** Only show the columns and rows of the canvas with the lower left corner at column, row of the canvas, such
+                 * as for a pane that shows part of a larger canvas. */
+                Canvas& setClip(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows);
+                Canvas& clearClip() { return setClip(0, 0, UINT32_MAX, UINT32_MAX); }
+
+                int column() const { return mColumn; }
+                int row() const { return mRow; }
+                unsigned int columns() const { return mSize.columns; }
+                unsigned int rows() const { return mSize.rows; }
+                int z() const { return mZ; }
+                bool visible() const { return mVisible; }
+
+        private:
+                friend class Terminal;
+
+                /** Rows [top, bottom) from the top and columns [left, right), which may be outside the screen. */
+                struct Area { int64_t top, left, bottom, right; };
+                /** What Terminal::swapDrawTarget() exchanges, which is the screen's while drawing on the canvas. */
+                struct DrawState {
+                        unsigned int rows, columns, cursorRow, cursorColumn, marginTop, marginBottom;
+                        bool wrapPending;
+                };
+
+                Terminal& mTerminal;
+                ScreenBuffer mBuffer;
+                DrawState mState;
+                Damage mDamage;
+                Size mSize;
+                int mColumn;
+                int mRow;
+                int mZ;
+                uint64_t mSequence{0};
+                bool mVisible{true};
+                /** As given to setClip(). */
+                unsigned int mClipColumn{0}, mClipRow{0}, mClipColumns{UINT32_MAX}, mClipRows{UINT32_MAX};
+
+                /** The row of the screen, from the top, that the top of the canvas is at. */
+                int64_t screenTop(unsigned int screenRows) const { return int64_t(screenRows) - mRow - mSize.rows; }
+                /** The part of the canvas that is shown, in rows from its top and its columns. */
+                Area clipArea() const;
 };
 
 #endif
@@ -0,0 +1,267 @@
+#include "terminalio.hpp"
+#include "screencanvas.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+/** SIGWINCH is reported by writing to this pipe, so that it can be polled together with the input. */
+static int global_sigwinch_pipe[2] = {-1, -1};
+
+static void sigwinch_handler(int)
+{
+        int savedErrno = errno;
+        char signalled = 1;
+        // If the pipe is full a resize is already pending, so ignore failure.
+        if (write(global_sigwinch_pipe[1], &signalled, 1) < 0) {}
+        errno = savedErrno;
+}
+
+static void makePipe(int (&fds)[2]) {
+        if (pipe(fds) < 0) {
+                perror("pipe() failed");
+                exit(1);
+        }
+        for (int fd : fds) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+}
+
+/** The read end of the SIGWINCH pipe, installing the handler the first time. */
+static int sigwinchPipe() {
+        if (global_sigwinch_pipe[0] == -1) {
+                makePipe(global_sigwinch_pipe);
+                struct sigaction newSigAction;
+                newSigAction.sa_handler = sigwinch_handler;
+                sigemptyset(&newSigAction.sa_mask);
+                newSigAction.sa_flags = SA_RESTART;
+                struct sigaction oldSigAction;
+                if (sigaction(SIGWINCH, &newSigAction, &oldSigAction) < 0) {
+                        perror("sigaction() failed");
+                        exit(1);
+                }
+        }
+        return global_sigwinch_pipe[0];
+}
+
+/** Read everything written to a pipe, returning if anything was. */
+static bool drainPipe(int fd) {
+        char buffer[64];
+        bool drained = false;
+        while (read(fd, buffer, sizeof(buffer)) > 0) drained = true;
+        return drained;
+}
+
+/** Milliseconds until the deadline for poll(), rounded up so that the deadline has passed when poll() times out. */
+static int pollTimeout(uint64_t deadline) {
+        if (deadline == UINT64_MAX) return -1;
+        uint64_t now = Terminal::monotonicNanos();
+        return (now >= deadline) ? 0 : int((deadline - now + 999999) / 1000000);
+}
+
+FdIo::FdIo(int inputFd, int outputFd) : FdIo(inputFd, outputFd, isatty(inputFd) ? sigwinchPipe() : -1, true) {
+}
+
+FdIo::FdIo(int inputFd, int outputFd, int resizeFd, bool wakeable) : mInputFd(inputFd), mOutputFd(outputFd), mResizeFd(resizeFd) {
+        if (wakeable) makePipe(mWakePipe);
+}
+
+FdIo::~FdIo() {
+        for (int fd : mWakePipe) {
+                if (fd != -1) close(fd);
+        }
+}
+
+void FdIo::wakeUp() {
+        char woken = 1;
+        // If the pipe is full a wake-up is already pending, so ignore failure.
+        if (mWakePipe[1] != -1 && ::write(mWakePipe[1], &woken, 1) < 0) {}
+}
+
+unsigned int FdIo::wait(uint64_t deadline) {
+        while (true) {
+                unsigned int ready = 0;
+                uint64_t settledTime = UINT64_MAX;
+                if (mResizeSettling) {
+                        // Dragging a window border sends a burst of signals, so report a single resize once they stop.
+                        settledTime = std::min(mLastResizeTime + RESIZE_SETTLE_MILLISECONDS * 1000000ull,
+                                        mFirstResizeTime + RESIZE_COALESCE_MAX_MILLISECONDS * 1000000ull);
+                        if (Terminal::monotonicNanos() >= settledTime) {
+                                mResizeSettling = false;
+                                ready |= RESIZE;
+                        }
+                }
+                // Descriptors of -1 are left out by poll().
+                struct pollfd pollFds[3] = { { mInputFd, POLLIN, 0 }, { mResizeFd, POLLIN, 0 }, { mWakePipe[0], POLLIN, 0 } };
+                int timeout = (ready != 0) ? 0 : pollTimeout(std::min(deadline, settledTime));
+                int pollResult = poll(pollFds, 3, timeout);
+                if (pollResult < 0) {
+                        if (errno == EINTR) continue;
+                        return FAILED;
+                }
+                // End of input and errors are reported by read().
+                if (pollFds[0].revents & (POLLIN | POLLHUP | POLLERR)) ready |= INPUT;
+                if ((pollFds[1].revents & POLLIN) && drainPipe(mResizeFd)) {
+                        uint64_t now = Terminal::monotonicNanos();
+                        if (!mResizeSettling) mFirstResizeTime = now;
+                        mLastResizeTime = now;
+                        mResizeSettling = true;
+                }
+                bool woken = (pollFds[2].revents & POLLIN) && drainPipe(mWakePipe[0]);
+                if (ready != 0 || woken || Terminal::monotonicNanos() >= deadline) return ready;
+        }
+}
+
+ssize_t FdIo::read(uint8_t* buffer, size_t capacity) {
+        return ::read(mInputFd, buffer, capacity);
+}
+
+unsigned int FdIo::write(char const* data, size_t length, size_t& written) {
+        written = 0;
+        unsigned int calls = 0;
+        while (written < length) {
+                ssize_t result = ::write(mOutputFd, data + written, length - written);
+                calls++;
+                if (result >= 0) {
+                        written += result;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        struct pollfd pollFd = { mOutputFd, POLLOUT, 0 };
+                        poll(&pollFd, 1, -1);
+                } else if (errno != EINTR) {
+                        break;
+                }
+        }
+        return calls;
+}
+
+bool FdIo::size(Size& size) {
+        struct winsize termSize;
+        if (ioctl(mInputFd, TIOCGWINSZ, (char*) &termSize) < 0 && ioctl(mOutputFd, TIOCGWINSZ, (char*) &termSize) < 0) return false;
+        size = Size{termSize.ws_row, termSize.ws_col};
+        return true;
+}
+
+void FdIo::setRawMode(bool raw) {
+        if (raw == mRaw) return;
+        if (raw) {
+                if (tcgetattr(mInputFd, &mOriginalMode) < 0) return;
+                struct termios trm = mOriginalMode;
+                trm.c_cc[VMIN] = 1; 	// Minimum number of characters for noncanonical read (MIN).
+                trm.c_cc[VTIME] = 0; 	// Timeout in deciseconds for noncanonical read (TIME).
+                // echo off, canonical mode off, extended input processing off, signal chars off:
+                trm.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+                tcsetattr(mInputFd, TCSANOW, &trm);
+        } else {
+                tcsetattr(mInputFd, TCSANOW, &mOriginalMode);
+        }
+        mRaw = raw;
+}
+
+unsigned int MemoryIo::wait(uint64_t) {
+        unsigned int ready = (mInputOffset < mInput.size()) ? INPUT : 0;
+        if (mResized) ready |= RESIZE;
+        mResized = false;
+        return ready;
+}
+
+ssize_t MemoryIo::read(uint8_t* buffer, size_t capacity) {
+        size_t length = std::min(capacity, mInput.size() - mInputOffset);
+        memcpy(buffer, mInput.data() + mInputOffset, length);
+        mInputOffset += length;
+        if (mInputOffset == mInput.size()) {
+                mInput.clear();
+                mInputOffset = 0;
+        }
+        return ssize_t(length);
+}
+
+unsigned int MemoryIo::write(char const* data, size_t length, size_t& written) {
+        written = length;
+        mBytesWritten += length;
+        if (mKeepOutput) mOutput.insert(mOutput.end(), data, data + length);
+        return 0;
+}
+
+MemoryIo& MemoryIo::setSize(Size size) {
+        mResized = true;
+        mSize = size;
+        return *this;
+}
+
+MemoryIo& MemoryIo::feed(void const* data, size_t length) {
+        if (mInputOffset > 0) {
+                // Move what is left to the start rather than growing.
+                mInput.erase(mInput.begin(), mInput.begin() + mInputOffset);
+                mInputOffset = 0;
+        }
+        mInput.insert(mInput.end(), (uint8_t const*) data, (uint8_t const*) data + length);
+        return *this;
+}
+
+PtyIo::PtyIo(Size size) : PtyIo(open(size)) {
+}
+
+PtyIo::PtyIo(Fds fds) : FdIo(fds.slave, fds.slave, fds.resizePipe[0], true), mMasterFd(fds.master), mSlaveFd(fds.slave), mResizePipe{fds.resizePipe[0], fds.resizePipe[1]} {
+}
+
+PtyIo::Fds PtyIo::open(Size size) {
+        Fds fds;
+        struct winsize termSize = {};
+        termSize.ws_row = (unsigned short) size.rows;
+        termSize.ws_col = (unsigned short) size.columns;
+        if (openpty(&fds.master, &fds.slave, nullptr, nullptr, &termSize) < 0) {
+                perror("openpty() failed");
+                exit(1);
+        }
+        fcntl(fds.master, F_SETFL, fcntl(fds.master, F_GETFL) | O_NONBLOCK);
+        fcntl(fds.master, F_SETFD, FD_CLOEXEC);
+        fcntl(fds.slave, F_SETFD, FD_CLOEXEC);
+        makePipe(fds.resizePipe);
+        return fds;
+}
+
+PtyIo::~PtyIo() {
+        setRawMode(false);
+        for (int fd : {mMasterFd, mSlaveFd, mResizePipe[0], mResizePipe[1]}) close(fd);
+}
+
+PtyIo& PtyIo::setSize(Size size) {
+        struct winsize termSize = {};
+        termSize.ws_row = (unsigned short) size.rows;
+        termSize.ws_col = (unsigned short) size.columns;
+        ioctl(mMasterFd, TIOCSWINSZ, (char*) &termSize);
+        // The SIGWINCH from the kernel goes to the foreground process group of the pseudo-terminal, which is not ours.
+        char signalled = 1;
+        if (::write(mResizePipe[1], &signalled, 1) < 0) {}
+        return *this;
+}
+
+PtyIo& PtyIo::writeInput(void const* data, size_t length) {
+        size_t written = 0;
+        while (written < length) {
+                ssize_t result = ::write(mMasterFd, (char const*) data + written, length - written);
+                if (result >= 0) {
+                        written += result;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        struct pollfd pollFd = { mMasterFd, POLLOUT, 0 };
+                        poll(&pollFd, 1, -1);
+                } else if (errno != EINTR) {
+                        break;
+                }
+        }
+        return *this;
+}
+
+ssize_t PtyIo::readOutput(char* buffer, size_t capacity) {
+        return ::read(mMasterFd, buffer, capacity);
+}
@@ -0,0 +1,149 @@
+#ifndef TERMINALIO_HPP_INCLUDED
+#define TERMINALIO_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <termios.h>
+
+#include <vector>
+
+struct Size { unsigned int rows, columns; };
+/** A range of bytes owned by someone else. */
+struct ByteSpan { uint8_t const* data; size_t length; };
+
+/** Where a Terminal reads its input from and writes its output to, and how it learns the size of the screen. */
+class TerminalIo {
+        public:
+                /** Bits returned by wait(). */
+                static const unsigned int INPUT = 1;
+                static const unsigned int RESIZE = 2;
+                /** Waiting failed, with errno telling why, so that the input cannot be read any more. */
+                static const unsigned int FAILED = 4;
+
+                virtual ~TerminalIo() {}
+                /** Wait until there is input or the size may have changed, or until the deadline in Terminal::monotonicNanos()
+                 * time has passed, where UINT64_MAX means waiting forever. Returns INPUT, RESIZE and FAILED bits, or 0 on timeout. */
+                virtual unsigned int wait(uint64_t deadline) = 0;
+                /** Read input after wait() reported INPUT, returning like read(2), with 0 at the end of the input. */
+                virtual ssize_t read(uint8_t* buffer, size_t capacity) = 0;
+                /** Write all of the output, blocking until it has been accepted, and set written to how much was. That is
+                 * less than length only if writing failed, with errno telling why. Returns the number of write() system
+                 * calls it took. */
+                virtual unsigned int write(char const* data, size_t length, size_t& written) = 0;
+                /** The size of the screen, or false if not known. */
+                virtual bool size(Size& size) = 0;
+                /** Turn off echo, line editing and signal keys while a Terminal is using it, or restore the previous mode. */
+                virtual void setRawMode(bool raw) { (void) raw; }
+                /** The value of an environment variable of the terminal, such as COLORTERM, or nullptr if not known. */
+                virtual char const* environment(char const* name) { (void) name; return nullptr; }
+                /** If wakeUp() works, so that wait() can be given no deadline by a thread that must be stopped by another one. */
+                virtual bool wakeable() const { return false; }
+                /** Make a wait() that blocks on another thread return 0 at once, or the next wait() if none is waiting. */
+                virtual void wakeUp() {}
+};
+
+/** A pair of file descriptors such as stdin and stdout, which may also be pipes or sockets. The size is that of the
+ * terminal if the input is one, in which case SIGWINCH is reported as RESIZE once a burst of them has settled, by the
+ * first wait() after that, which does not wait past its deadline for it. The environment is that of this process,
+ * which describes the terminal it was started in. wakeUp() writes to a pipe that wait() polls together with the
+ * input. The descriptors are not closed. */
+class FdIo : public TerminalIo {
+        public:
+                FdIo(int inputFd, int outputFd);
+                ~FdIo();
+
+                unsigned int wait(uint64_t deadline) override;
+                ssize_t read(uint8_t* buffer, size_t capacity) override;
+                unsigned int write(char const* data, size_t length, size_t& written) override;
+                bool size(Size& size) override;
+                void setRawMode(bool raw) override;
+                char const* environment(char const* name) override { return getenv(name); }
+                bool wakeable() const override { return mWakePipe[1] != -1; }
+                void wakeUp() override;
+
+                int inputFd() const { return mInputFd; }
+                int outputFd() const { return mOutputFd; }
+        protected:
+                /** Like the public constructor, but with a pipe that is written to when the size changes, or -1 for none,
+                 * and without the pipe of wakeUp() unless wakeable is set, since the fds of many sessions add up. */
+                FdIo(int inputFd, int outputFd, int resizeFd, bool wakeable);
+        private:
+                int mInputFd;
+                int mOutputFd;
+                int mResizeFd;
+                int mWakePipe[2]{-1, -1};
+                bool mRaw{false};
+                struct termios mOriginalMode;
+                /** While writes to the resize pipe keep coming, when the first and the latest of them arrived. */
+                bool mResizeSettling{false};
+                uint64_t mFirstResizeTime{0};
+                uint64_t mLastResizeTime{0};
+
+                /** A resize is reported when no more writes to the resize pipe have arrived for this long, or after the maximum time. */
+                static const unsigned int RESIZE_SETTLE_MILLISECONDS = 25;
+                static const unsigned int RESIZE_COALESCE_MAX_MILLISECONDS = 100;
+};
+
+/** Input and output in memory with a size that is set by the owner, to drive a Terminal without a terminal, such as in
+ * benchmarks. Buffers keep their capacity, so that no memory is allocated once they are large enough. */
+class MemoryIo : public TerminalIo {
+        public:
+                explicit MemoryIo(Size size = Size{24, 80}) : mSize(size) {}
+
+                /** Never blocks, since nothing can arrive while waiting, and returns 0 if there is no input and no resize. */
+                unsigned int wait(uint64_t deadline) override;
+                ssize_t read(uint8_t* buffer, size_t capacity) override;
+                unsigned int write(char const* data, size_t length, size_t& written) override;
+                bool size(Size& size) override { size = mSize; return true; }
+
+                /** Change the size, which the Terminal sees as a RESIZE event. */
+                MemoryIo& setSize(Size size);
+                /** Queue input for the Terminal to read. */
+                MemoryIo& feed(void const* data, size_t length);
+                /** Count the output without keeping it, which makes writing free of copying. */
+                MemoryIo& setKeepOutput(bool keep) { mKeepOutput = keep; return *this; }
+
+                /** The output kept since the last clearOutput(). */
+                ByteSpan output() const { return ByteSpan{(uint8_t const*) mOutput.data(), mOutput.size()}; }
+                MemoryIo& clearOutput() { mOutput.clear(); return *this; }
+                /** The number of bytes written in total, whether kept or not. */
+                uint64_t bytesWritten() const { return mBytesWritten; }
+        private:
+                Size mSize;
+                bool mResized{false};
+                std::vector<uint8_t> mInput;
+                size_t mInputOffset{0};
+                std::vector<char> mOutput;
+                bool mKeepOutput{true};
+                uint64_t mBytesWritten{0};
+};
+
+/** A pseudo-terminal from openpty(), where the Terminal uses the terminal side and the owner plays the terminal emulator
+ * on the master side. The master must be read as the Terminal writes, or writing blocks when the kernel buffer is full. */
+class PtyIo : public FdIo {
+        public:
+                explicit PtyIo(Size size = Size{24, 80});
+                ~PtyIo();
+
+                /** Change the size as a terminal emulator does, which the Terminal sees as a RESIZE event. */
+                PtyIo& setSize(Size size);
+                /** Send input as if typed into the terminal. */
+                PtyIo& writeInput(void const* data, size_t length);
+                /** Read what the Terminal has written without blocking, returning like read(2). */
+                ssize_t readOutput(char* buffer, size_t capacity);
+                /** The emulated terminal has no environment of its own. */
+                char const* environment(char const*) override { return nullptr; }
+                int masterFd() const { return mMasterFd; }
+        private:
+                struct Fds { int master, slave, resizePipe[2]; };
+                int mMasterFd;
+                int mSlaveFd;
+                int mResizePipe[2];
+
+                explicit PtyIo(Fds fds);
+                static Fds open(Size size);
+};
+
+#endif
@@ -0,0 +1,687 @@
+#include "screencanvas.hpp"
+
+#include <fcntl.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// Tests of the library driven through a MemoryIo, pipes and a PtyIo, so that no terminal is needed. Failed checks are
+// printed with what was expected, and the exit status tells if any failed. Give group names as arguments to only run
+// those.
+
+static int groupCount;
+static char** groups;
+static unsigned int checks;
+static unsigned int failures;
+
+static bool enabled(char const* group) {
+        if (groupCount == 0) return true;
+        for (int i = 0; i < groupCount; i++) {
+                if (strcmp(groups[i], group) == 0) return true;
+        }
+        return false;
+}
+
+/** Output with control characters made visible, such as \e for ESC, so that failures can be read. */
+static std::string visible(std::string const& text) {
+        std::string result;
+        for (unsigned char c : text) {
+                if (c == 27) {
+                        result += "\\e";
+                } else if (c == '\r') {
+                        result += "\\r";
+                } else if (c == '\n') {
+                        result += "\\n";
+                } else if (c < 32 || c == 127) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\x%02x", c);
+                        result += escaped;
+                } else {
+                        result += char(c);
+                }
+        }
+        return result;
+}
+
+static void check(bool passed, char const* condition, char const* file, int line) {
+        checks++;
+        if (passed) return;
+        failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+}
+
+static void checkEqual(std::string const& actual, std::string const& expected, char const* expression, char const* file, int line) {
+        checks++;
+        if (actual == expected) return;
+        failures++;
+        fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", file, line, expression, visible(actual).c_str(), visible(expected).c_str());
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) checkEqual((actual), (expected), #actual, __FILE__, __LINE__)
+
+static uint8_t modifierBit(ModifierKey modifier) {
+        return uint8_t(1 << int(modifier));
+}
+
+/** The output written since the last call. */
+static std::string takeOutput(MemoryIo& io) {
+        ByteSpan output = io.output();
+        std::string result((char const*) output.data, output.length);
+        io.clearOutput();
+        return result;
+}
+
+/** The events that input gives, read until there are no more without waiting. Their text stays valid until the next call. */
+static std::vector<Event> parse(Terminal& term, MemoryIo& io, char const* input) {
+        static std::deque<std::string> texts;
+        texts.clear();
+        io.feed(input, strlen(input));
+        std::vector<Event> events;
+        while (term.await(0) != EventType::TIMEOUT) {
+                Event event = term.lastEvent();
+                if (event.type == EventType::TEXT || event.type == EventType::PASTE) {
+                        texts.emplace_back((char const*) event.text.data, event.text.length);
+                        event.text.data = (uint8_t const*) texts.back().data();
+                }
+                events.push_back(event);
+        }
+        return events;
+}
+
+static std::vector<Event> parse(char const* input, bool textRuns = false) {
+        MemoryIo io;
+        Terminal term(io);
+        term.setTextRuns(textRuns);
+        return parse(term, io, input);
+}
+
+static bool isChar(Event const& event, uint32_t character, uint8_t modifiers = 0) {
+        return event.type == EventType::CHAR && event.character == character && event.modifiers == modifiers;
+}
+
+static bool isKey(Event const& event, Key key, uint8_t modifiers = 0) {
+        return event.type == EventType::KEY && event.key == key && event.modifiers == modifiers;
+}
+
+static std::string text(Event const& event) {
+        return std::string((char const*) event.text.data, event.text.length);
+}
+
+static void testCharacters() {
+        std::vector<Event> events = parse("a\r\x7f\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+        CHECK(events.size() == 6);
+        if (events.size() == 6) {
+                CHECK(isChar(events[0], 'a'));
+                CHECK(isChar(events[1], '\r'));
+                CHECK(isChar(events[2], 0x7f));
+                CHECK(isChar(events[3], 0xE9));
+                CHECK(isChar(events[4], 0x20AC));
+                CHECK(isChar(events[5], 0x1F600));
+        }
+
+        // An invalid byte is replaced, and a byte that cuts a sequence short starts over.
+        events = parse("\xff" "a\xc3" "b");
+        CHECK(events.size() == 4);
+        if (events.size() == 4) {
+                CHECK(isChar(events[0], 0xFFFD));
+                CHECK(isChar(events[1], 'a'));
+                CHECK(isChar(events[2], 0xFFFD));
+                CHECK(isChar(events[3], 'b'));
+        }
+
+        // ESC before a character is alt, also before UTF-8.
+        events = parse("\033x\033\xc3\xa9");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(isChar(events[0], 'x', modifierBit(ModifierKey::ALT)));
+                CHECK(isChar(events[1], 0xE9, modifierBit(ModifierKey::ALT)));
+        }
+}
+
+static void testKeys() {
+        uint8_t const CTRL = modifierBit(ModifierKey::CTRL), SHIFT = modifierBit(ModifierKey::SHIFT), ALT = modifierBit(ModifierKey::ALT);
+        std::vector<Event> events = parse("\033[A\033OB\033[1;5C\033[1;2D\033[H\033OF\033[3~\033[15;2~\033[24~\033[Z\033OP\033[1;3S");
+        CHECK(events.size() == 12);
+        if (events.size() == 12) {
+                CHECK(isKey(events[0], Key::UP));
+                CHECK(isKey(events[1], Key::DOWN));
+                CHECK(isKey(events[2], Key::RIGHT, CTRL));
+                CHECK(isKey(events[3], Key::LEFT, SHIFT));
+                CHECK(isKey(events[4], Key::HOME));
+                CHECK(isKey(events[5], Key::END));
+                CHECK(isKey(events[6], Key::DELETE));
+                CHECK(isKey(events[7], Key::F5, SHIFT));
+                CHECK(isKey(events[8], Key::F12));
+                CHECK(isKey(events[9], Key::BACK_TAB));
+                CHECK(isKey(events[10], Key::F1));
+                CHECK(isKey(events[11], Key::F4, ALT));
+        }
+
+        // Modified characters with CSI u and with modifyOtherKeys, and the application keypad.
+        events = parse("\033[97;5u\033[27;6;65~\033Ok\033OM");
+        CHECK(events.size() == 4);
+        if (events.size() == 4) {
+                CHECK(isChar(events[0], 'a', CTRL));
+                CHECK(isChar(events[1], 'A', CTRL | SHIFT));
+                CHECK(isChar(events[2], '+'));
+                CHECK(isChar(events[3], '\r'));
+        }
+
+        // An unknown sequence is skipped as a whole.
+        events = parse("\033[99~\033[1;2;3;4Ax");
+        CHECK(events.size() == 1);
+        if (events.size() == 1) CHECK(isChar(events[0], 'x'));
+}
+
+static void testTextRuns() {
+        // Printable text up to a control character comes as one event.
+        std::vector<Event> events = parse("hello w\xc3\xb6rld\rok", true);
+        CHECK(events.size() == 3);
+        if (events.size() == 3) {
+                CHECK(events[0].type == EventType::TEXT);
+                CHECK_EQUAL(text(events[0]), "hello w\xc3\xb6rld");
+                CHECK(isChar(events[1], '\r'));
+                CHECK(events[2].type == EventType::TEXT);
+                CHECK_EQUAL(text(events[2]), "ok");
+        }
+
+        // Without text runs, the same input is one event per character.
+        events = parse("ok");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(isChar(events[0], 'o'));
+                CHECK(isChar(events[1], 'k'));
+        }
+}
+
+static void testEscapeTimeout() {
+        MemoryIo waitingIo;
+        Terminal waiting(waitingIo);
+        // Nothing has followed the ESC for long enough yet.
+        CHECK(parse(waiting, waitingIo, "\033").empty());
+
+        MemoryIo io;
+        Terminal term(io);
+        term.setEscapeTimeout(0);
+        std::vector<Event> events = parse(term, io, "\033");
+        CHECK(events.size() == 1);
+        if (events.size() == 1) CHECK(isChar(events[0], 27));
+
+        // ESC [ without more is alt+[.
+        events = parse(term, io, "\033[");
+        CHECK(events.size() == 1);
+        if (events.size() == 1) CHECK(isChar(events[0], '[', modifierBit(ModifierKey::ALT)));
+
+        // A sequence that arrives in pieces is still one key.
+        term.setEscapeTimeout(1000);
+        CHECK(parse(term, io, "\033[1;").empty());
+        events = parse(term, io, "5A");
+        CHECK(events.size() == 1);
+        if (events.size() == 1) CHECK(isKey(events[0], Key::UP, modifierBit(ModifierKey::CTRL)));
+}
+
+static void testMouseAndFocus() {
+        MemoryIo io(Size{24, 80});
+        Terminal term(io);
+        std::vector<Event> events = parse(term, io, "\033[<0;10;5M\033[<0;10;5m\033[<32;11;5M\033[<35;1;24M\033[<65;1;1M\033[<18;2;3M\033[I\033[O");
+        CHECK(events.size() == 8);
+        if (events.size() != 8) return;
+        CHECK(events[0].type == EventType::MOUSE_DOWN && events[0].mouseButton == 0 && events[0].column == 9 && events[0].row == 19);
+        CHECK(events[1].type == EventType::MOUSE_UP && events[1].column == 9 && events[1].row == 19);
+        CHECK(events[2].type == EventType::MOUSE_MOVED_PRESSED && events[2].column == 10);
+        CHECK(events[3].type == EventType::MOUSE_MOVED && events[3].mouseButton == 3 && events[3].row == 0);
+        CHECK(events[4].type == EventType::MOUSE_DOWN && events[4].mouseButton == 5 && events[4].row == 23);
+        CHECK(events[5].type == EventType::MOUSE_DOWN && events[5].mouseButton == 2 && events[5].modifiers == modifierBit(ModifierKey::CTRL));
+        CHECK(events[6].type == EventType::FOCUS_IN);
+        CHECK(events[7].type == EventType::FOCUS_OUT);
+
+        // Consecutive motion is merged into the latest position.
+        io.feed("\033[<35;1;1M\033[<35;2;1M\033[<35;3;1Mq", 31);
+        Event batch[8];
+        size_t count = term.awaitBatch(batch, 8, 0);
+        CHECK(count == 2);
+        if (count == 2) {
+                CHECK(batch[0].type == EventType::MOUSE_MOVED && batch[0].column == 2);
+                CHECK(isChar(batch[1], 'q'));
+        }
+}
+
+static void testPaste() {
+        MemoryIo io;
+        Terminal term(io);
+        term.setBracketedPasteMode(true);
+        term.flush();
+        CHECK_EQUAL(takeOutput(io), "\033[?2004h");
+        std::vector<Event> events = parse(term, io, "\033[200~one\r\033[Atwo\033[201~x");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(events[0].type == EventType::PASTE && events[0].pasteFinished);
+                CHECK_EQUAL(text(events[0]), "one\r\033[Atwo");
+                CHECK(isChar(events[1], 'x'));
+        }
+
+        // A paste that arrives in pieces is delivered as it comes, with only the last piece finishing it.
+        events = parse(term, io, "\033[200~abc");
+        CHECK(events.size() == 1);
+        if (events.size() == 1) CHECK(events[0].type == EventType::PASTE && !events[0].pasteFinished && text(events[0]) == "abc");
+        events = parse(term, io, "def\033[201~");
+        std::string pasted;
+        for (Event const& event : events) pasted += text(event);
+        CHECK_EQUAL(pasted, "def");
+        CHECK(!events.empty() && events.back().pasteFinished);
+}
+
+static void testCursorPosition() {
+        MemoryIo io(Size{24, 80});
+        Terminal term(io);
+        // A report is told apart from F3 by its row, or by having asked for one.
+        std::vector<Event> events = parse(term, io, "\033[12;40R\033[1;5R");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(events[0].type == EventType::CURSOR_POSITION && events[0].row == 12 && events[0].column == 39);
+                CHECK(isKey(events[1], Key::F3, modifierBit(ModifierKey::CTRL)));
+        }
+        term.requestCursorPosition().flush();
+        CHECK_EQUAL(takeOutput(io), "\033[6n");
+        events = parse(term, io, "\033[1;5R\033[1;5R");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(events[0].type == EventType::CURSOR_POSITION && events[0].row == 23 && events[0].column == 4);
+                CHECK(isKey(events[1], Key::F3, modifierBit(ModifierKey::CTRL)));
+        }
+}
+
+static void testDcs() {
+        MemoryIo io;
+        Terminal term(io);
+        // Without a probe, ESC P is alt+P.
+        std::vector<Event> events = parse(term, io, "\033Px");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(isChar(events[0], 'P', modifierBit(ModifierKey::ALT)));
+                CHECK(isChar(events[1], 'x'));
+        }
+
+        // While probing, a DCS string too long to be a reply is skipped up to its ST.
+        term.probeCapabilities(1000, false);
+        std::string input = "\033P" + std::string(5000, 'z') + "\033\\ab";
+        events = parse(term, io, input.c_str());
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(isChar(events[0], 'a'));
+                CHECK(isChar(events[1], 'b'));
+        }
+        CHECK(term.terminalVersion().empty());
+}
+
+/** Input through a pipe that is closed after it, to see how its end is reported. */
+static std::vector<Event> parseUntilEnd(char const* input) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+                perror("pipe()");
+                exit(1);
+        }
+        if (write(fds[1], input, strlen(input)) != ssize_t(strlen(input))) {
+                perror("write()");
+                exit(1);
+        }
+        close(fds[1]);
+        int output = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        std::vector<Event> events;
+        {
+                FdIo io(fds[0], output);
+                Terminal term(io);
+                while (events.size() < 10) {
+                        EventType type = term.await(1000);
+                        if (type == EventType::TIMEOUT) break;
+                        events.push_back(term.lastEvent());
+                        if (type == EventType::INPUT_ENDED) break;
+                }
+                // Later calls keep returning it at once.
+                if (term.await(1000) != EventType::INPUT_ENDED) events.push_back(Event());
+        }
+        close(fds[0]);
+        close(output);
+        return events;
+}
+
+static void testInputEnded() {
+        std::vector<Event> events = parseUntilEnd("ab");
+        CHECK(events.size() == 3);
+        if (events.size() == 3) {
+                CHECK(isChar(events[0], 'a'));
+                CHECK(isChar(events[1], 'b'));
+                CHECK(events[2].type == EventType::INPUT_ENDED && events[2].error == 0);
+        }
+
+        // An ESC at the end is the escape key, without waiting for more.
+        events = parseUntilEnd("x\033");
+        CHECK(events.size() == 3);
+        if (events.size() == 3) {
+                CHECK(isChar(events[0], 'x'));
+                CHECK(isChar(events[1], 27));
+                CHECK(events[2].type == EventType::INPUT_ENDED);
+        }
+
+        events = parseUntilEnd("");
+        CHECK(events.size() == 1 && events[0].type == EventType::INPUT_ENDED);
+}
+
+/** A Terminal in retained mode on a MemoryIo, with the output of entering it discarded. */
+struct Screen {
+        MemoryIo io;
+        Terminal term;
+
+        explicit Screen(Size size, uint32_t capabilities = 0) : io(size), term(io) {
+                term.setCapabilities(capabilities).setRetainedMode(true).setAutoPresent(false);
+                term.hideCursor();
+                term.clear().present();
+                takeOutput(io);
+        }
+        std::string present() {
+                term.present();
+                return takeOutput(io);
+        }
+};
+
+static void testPresent() {
+        Screen screen(Size{4, 10});
+        Terminal& t = screen.term;
+        // Rows count from the bottom, while the terminal counts from 1 at the top.
+        t.placeCursor(2, 3).print("hi");
+        CHECK_EQUAL(screen.present(), "\033[1;3Hhi");
+        CHECK_EQUAL(screen.present(), "");
+        CHECK(!t.lastPresentChanged());
+
+        // Only the changed cell is sent.
+        t.placeCursor(3, 3).print("o");
+        CHECK_EQUAL(screen.present(), "\033[Do");
+
+        t.placeCursor(0, 0).setForeground(Color::RED).print("red").resetColorsAndStyle();
+        CHECK_EQUAL(screen.present(), "\033[3B\r\033[31mred");
+        t.placeCursor(0, 0).setAttribute(Attribute::BOLD, true).print("b").resetColorsAndStyle();
+        CHECK_EQUAL(screen.present(), "\r\033[0;1mb");
+
+        // Clearing the buffer and drawing the same again sends nothing.
+        t.clear();
+        t.placeCursor(2, 3).print("ho");
+        t.placeCursor(0, 0).setAttribute(Attribute::BOLD, true).print("b").resetColorsAndStyle();
+        t.setForeground(Color::RED).print("ed").resetColorsAndStyle();
+        CHECK_EQUAL(screen.present(), "");
+
+        t.repaint();
+        CHECK_EQUAL(screen.present(), "\033[m\033[2J\033[1;3Hho\033[3B\r\033[1mb\033[0;31med");
+}
+
+static void testPresentScrolls() {
+        Screen screen(Size{8, 30});
+        Terminal& t = screen.term;
+        // Rows that differ in every cell, so that scrolling saves drawing them.
+        auto line = [](unsigned int index) { return std::string(30, char('a' + index)); };
+        auto drawLines = [&t, &line](unsigned int first) {
+                t.clear();
+                for (unsigned int row = 0; row < 8; row++) t.placeCursor(0, 7 - row).print("%s", line(first + row).c_str());
+        };
+        drawLines(0);
+        screen.present();
+        // Content moving up by one row is scrolled, so only the new bottom row is drawn.
+        drawLines(1);
+        CHECK_EQUAL(screen.present(), "\033[H\033[1M\033[7B" + line(8));
+        drawLines(0);
+        CHECK_EQUAL(screen.present(), "\033[H\033[1L" + line(0));
+
+        // Within part of the screen, the scrolling region is set around it, and the row scrolled in is already blank.
+        t.placeCursor(0, 0).print("%-30s", "status");
+        screen.present();
+        for (unsigned int row = 1; row < 7; row++) t.placeCursor(0, 7 - row).print("%s", line(row + 1).c_str());
+        t.placeCursor(0, 1).print("%-30s", "");
+        CHECK_EQUAL(screen.present(), "\033[2;7r\033[1S\033[r");
+}
+
+static uint32_t capabilityBit(Capability capability) {
+        return 1u << int(capability);
+}
+
+static void testPresentColors() {
+        Screen screen(Size{2, 10});
+        Terminal& t = screen.term;
+        t.placeCursor(0, 1).setForegroundIndexed(208).setBackgroundIndexed(17).print("a").resetColorsAndStyle();
+        CHECK_EQUAL(screen.present(), "\033[H\033[38;5;208;48;5;17ma");
+        // Without true color, a 24-bit color is sent as the closest one in the palette.
+        t.placeCursor(0, 1).setForegroundRgb(255, 0, 0).print("b").resetColorsAndStyle();
+        CHECK_EQUAL(screen.present(), "\r\033[0;38;5;196mb");
+
+        Screen trueColor(Size{2, 10}, capabilityBit(Capability::TRUE_COLOR));
+        trueColor.term.placeCursor(0, 1).setForegroundRgb(1, 2, 3).setAttribute(Attribute::UNDERLINE, true).print("c");
+        CHECK_EQUAL(trueColor.present(), "\033[H\033[4;38;2;1;2;3mc");
+}
+
+static void testPresentCosts() {
+        // A run of the same character is repeated with REP when the terminal has it.
+        Screen repeat(Size{3, 20}, capabilityBit(Capability::REPEAT));
+        repeat.term.placeCursor(0, 1).print("%s", std::string(20, 'x').c_str());
+        CHECK_EQUAL(repeat.present(), "\033[2;1Hx\033[19b");
+        Screen noRepeat(Size{3, 20});
+        noRepeat.term.placeCursor(0, 1).print("%s", std::string(20, 'x').c_str());
+        CHECK_EQUAL(noRepeat.present(), "\033[2;1H" + std::string(20, 'x'));
+        // Short runs are cheaper to write out.
+        repeat.term.placeCursor(0, 0).print("yyy");
+        CHECK_EQUAL(repeat.present(), "\033[3;1Hyyy");
+
+        // Blanks in the middle of a row are erased with ECH, and at its end with EL or ED.
+        Screen erase(Size{3, 20});
+        Terminal& t = erase.term;
+        t.placeCursor(0, 2).print("%s", std::string(20, 'a').c_str());
+        t.placeCursor(0, 1).print("%s", std::string(20, 'b').c_str());
+        erase.present();
+        t.placeCursor(1, 2).print("%s", std::string(18, ' ').c_str());
+        CHECK_EQUAL(erase.present(), "\033[1;2H\033[18X");
+        t.placeCursor(5, 2).print("%s", std::string(15, ' ').c_str());
+        t.placeCursor(5, 1).print("%s", std::string(15, ' ').c_str());
+        CHECK_EQUAL(erase.present(), "\033[18C \033[2;6H\033[J");
+
+        // With bce, erasing uses the background of the blanks.
+        Screen background(Size{2, 20}, capabilityBit(Capability::BACKGROUND_COLOR_ERASE));
+        background.term.setBackground(Color::BLUE);
+        for (unsigned int row = 0; row < 2; row++) background.term.placeCursor(0, row).print("%20s", "");
+        CHECK_EQUAL(background.present(), "\033[H\033[44m\033[K\033[B\033[K");
+        Screen noBackground(Size{2, 4});
+        noBackground.term.setBackground(Color::BLUE);
+        for (unsigned int row = 0; row < 2; row++) noBackground.term.placeCursor(0, row).print("%4s", "");
+        CHECK_EQUAL(noBackground.present(), "\033[H\033[44m    \033[2;1H    ");
+}
+
+static void testPresentCopies() {
+        Screen screen(Size{6, 20}, capabilityBit(Capability::RECTANGULAR_EDITING));
+        Terminal& t = screen.term;
+        for (unsigned int row = 3; row < 6; row++) t.placeCursor(0, row).print("pane content %u", row);
+        screen.present();
+        // A copy of what is on screen is sent as DECCRA.
+        t.copyRectangle(0, 3, 14, 3, 5, 0);
+        CHECK_EQUAL(screen.present(), "\033[1;1;3;14;1;4;6;1$v");
+}
+
+static void testPresentSync() {
+        Screen screen(Size{6, 20}, capabilityBit(Capability::SYNCHRONIZED_UPDATES));
+        Terminal& t = screen.term;
+        t.setSynchronizedUpdates(true);
+        for (unsigned int row = 3; row < 6; row++) t.placeCursor(0, row).print("pane content %u", row);
+        CHECK_EQUAL(screen.present(), "\033[?2026h\033[Hpane content 5\033[B\rpane content 4\033[B\rpane content 3\033[?2026l");
+        CHECK(t.lastPresentChanged());
+        // Nothing to present is not wrapped.
+        CHECK_EQUAL(screen.present(), "");
+}
+
+static void testResize() {
+        Screen screen(Size{3, 10});
+        screen.term.placeCursor(0, 2).print("top");
+        screen.present();
+        screen.io.setSize(Size{4, 12});
+        CHECK(screen.term.await(0) == EventType::RESIZE);
+        Event const& event = screen.term.lastEvent();
+        CHECK(event.size.rows == 4 && event.size.columns == 12);
+        CHECK(screen.term.rows() == 4 && screen.term.columns() == 12);
+        // How the terminal has rearranged the screen is not known, so all of it is drawn again.
+        screen.term.placeCursor(0, 3).print("top");
+        CHECK_EQUAL(screen.present(), "\033[m\033[2J\033[Htop");
+}
+
+/** A terminal that names itself in its environment, for the capability cache. */
+class NamedIo : public MemoryIo {
+        public:
+                char const* environment(char const* name) override { return strcmp(name, "TERM") == 0 ? "screencanvas-test" : nullptr; }
+};
+
+static char const PROBE_QUERIES[] = "\033[>0q\033[>c\033[?2026$p\033[?2004$p\033[?1006$p\033[c";
+
+static void testProbe() {
+        MemoryIo io;
+        Terminal term(io);
+        term.probeCapabilities(1000, false);
+        CHECK_EQUAL(takeOutput(io), PROBE_QUERIES);
+        // The replies come with a keypress mixed in, and DA1 last.
+        std::vector<Event> events = parse(term, io, "\033P>|xterm(388)\033\\\033[>41;388;0cx\033[?2026;2$y\033[?2004;2$y\033[?1006;0$y\033[?62;22;28c");
+        CHECK(events.size() == 2);
+        if (events.size() == 2) {
+                CHECK(isChar(events[0], 'x'));
+                CHECK(events[1].type == EventType::CAPABILITIES);
+        }
+        CHECK(term.capabilitiesProbed());
+        CHECK_EQUAL(term.terminalVersion(), "xterm(388)");
+        CHECK(term.hasCapability(Capability::SYNCHRONIZED_UPDATES));
+        CHECK(term.hasCapability(Capability::BRACKETED_PASTE));
+        CHECK(!term.hasCapability(Capability::SGR_MOUSE));
+        CHECK(term.hasCapability(Capability::RECTANGULAR_EDITING));
+        // Known from the version.
+        CHECK(term.hasCapability(Capability::REPEAT));
+        CHECK(term.hasCapability(Capability::TRUE_COLOR));
+
+        // A terminal that only answers DA1 has none of what was asked about.
+        MemoryIo plainIo;
+        Terminal plain(plainIo);
+        plain.probeCapabilities(1000, false);
+        events = parse(plain, plainIo, "\033[?1;2c");
+        CHECK(events.size() == 1 && events[0].type == EventType::CAPABILITIES);
+        CHECK(!plain.hasCapability(Capability::SYNCHRONIZED_UPDATES));
+        CHECK(!plain.hasCapability(Capability::RECTANGULAR_EDITING));
+        CHECK(!plain.hasCapability(Capability::REPEAT));
+        CHECK(plain.hasCapability(Capability::BACKGROUND_COLOR_ERASE));
+
+        // Without replies, the probe gives up at its deadline.
+        MemoryIo silentIo;
+        Terminal silent(silentIo);
+        silent.probeCapabilities(0, false);
+        CHECK(silent.await(0) == EventType::CAPABILITIES);
+        CHECK(silent.capabilitiesProbed());
+}
+
+static void testProbeCache() {
+        char directory[] = "/tmp/screencanvas-test-XXXXXX";
+        if (mkdtemp(directory) == nullptr) {
+                perror("mkdtemp()");
+                exit(1);
+        }
+        std::string previousCacheHome = getenv("XDG_CACHE_HOME") ? getenv("XDG_CACHE_HOME") : "";
+        setenv("XDG_CACHE_HOME", directory, 1);
+        {
+                NamedIo io;
+                Terminal term(io);
+                term.probeCapabilities(1000, true);
+                CHECK_EQUAL(takeOutput(io), PROBE_QUERIES);
+                parse(term, io, "\033P>|foot(1.16)\033\\\033[?2026;2$y\033[?62;4c");
+                CHECK(term.capabilitiesProbed());
+        }
+        {
+                // The next probe in the same kind of terminal does not ask.
+                NamedIo io;
+                Terminal term(io);
+                term.setCapability(Capability::SYNCHRONIZED_UPDATES, false);
+                term.probeCapabilities(1000, true);
+                term.flush();
+                CHECK_EQUAL(takeOutput(io), "");
+                CHECK(term.await(0) == EventType::CAPABILITIES);
+                CHECK_EQUAL(term.terminalVersion(), "foot(1.16)");
+                CHECK(term.hasCapability(Capability::SYNCHRONIZED_UPDATES));
+                CHECK(term.hasCapability(Capability::REPEAT));
+                CHECK(!term.hasCapability(Capability::RECTANGULAR_EDITING));
+        }
+        std::string path = std::string(directory) + "/screencanvas/capabilities";
+        unlink(path.c_str());
+        rmdir((std::string(directory) + "/screencanvas").c_str());
+        rmdir(directory);
+        if (previousCacheHome.empty()) unsetenv("XDG_CACHE_HOME"); else setenv("XDG_CACHE_HOME", previousCacheHome.c_str(), 1);
+}
+
+/** Read what the Terminal has written to the pty until nothing more comes. */
+static std::string readPty(PtyIo& io) {
+        std::string result;
+        char buffer[4096];
+        for (int idle = 0; idle < 10;) {
+                ssize_t length = io.readOutput(buffer, sizeof(buffer));
+                if (length > 0) {
+                        result.append(buffer, size_t(length));
+                        idle = 0;
+                } else {
+                        usleep(1000);
+                        idle++;
+                }
+        }
+        return result;
+}
+
+static void testPty() {
+        PtyIo io(Size{10, 40});
+        Terminal term(io);
+        CHECK(term.rows() == 10 && term.columns() == 40);
+        io.writeInput("q\033[A", 4);
+        CHECK(term.await(1000) == EventType::CHAR && term.lastCharacter() == 'q');
+        CHECK(term.await(1000) == EventType::KEY && term.lastKey() == Key::UP);
+        CHECK(term.await(10) == EventType::TIMEOUT);
+
+        // A burst of size changes is reported once, with the last size.
+        io.setSize(Size{12, 50}).setSize(Size{14, 60});
+        CHECK(term.await(1000) == EventType::RESIZE);
+        CHECK(term.lastEvent().size.rows == 14 && term.lastEvent().size.columns == 60);
+        CHECK(term.await(50) == EventType::TIMEOUT);
+
+        term.setRetainedMode(true).setAutoPresent(false);
+        term.clear().placeCursor(0, 13).print("over a pty");
+        term.present().flush();
+        std::string output = readPty(io);
+        CHECK(output.find("\033[2J") != std::string::npos);
+        CHECK(output.find("over a pty") != std::string::npos);
+}
+
+int main(int argc, char** argv) {
+        groupCount = argc - 1;
+        groups = argv + 1;
+        if (enabled("parse")) {
+                testCharacters();
+                testKeys();
+                testTextRuns();
+                testEscapeTimeout();
+                testMouseAndFocus();
+                testPaste();
+                testCursorPosition();
+                testDcs();
+                testInputEnded();
+        }
+        if (enabled("present")) {
+                testPresent();
+                testPresentColors();
+                testPresentScrolls();
+                testPresentCosts();
+                testPresentCopies();
+                testPresentSync();
+                testResize();
+        }
+        if (enabled("probe")) {
+                testProbe();
+                testProbeCache();
+        }
+        if (enabled("pty")) testPty();
+        printf("%u checks, %u failed\n", checks, failures);
+        return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#ifndef TEXTSCAN_HPP_INCLUDED
+#define TEXTSCAN_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/** Return the length of the prefix of data consisting of printable ASCII, that is bytes in [0x20, 0x7E].
+ * Checks 16 bytes at a time where SSE2 or NEON is available. */
+inline size_t scanPrintableAscii(uint8_t const* data, size_t length) {
+        size_t i = 0;
+#if defined(__SSE2__)
+        __m128i const lastControl = _mm_set1_epi8(0x1F);
+        __m128i const del = _mm_set1_epi8(0x7F);
+        for (; i + 16 <= length; i += 16) {
+                __m128i chunk = _mm_loadu_si128((__m128i const*) (data + i));
+                // Bytes from 0x80 are negative when compared as signed, so this is true for exactly [0x20, 0x7F].
+                __m128i printable = _mm_andnot_si128(_mm_cmpeq_epi8(chunk, del), _mm_cmpgt_epi8(chunk, lastControl));
+                unsigned int special = ~unsigned(_mm_movemask_epi8(printable)) & 0xFFFF;
+                if (special != 0) return i + __builtin_ctz(special);
+        }
+#elif defined(__aarch64__)
+        for (; i + 16 <= length; i += 16) {
+                uint8x16_t chunk = vld1q_u8(data + i);
+                uint8x16_t special = vorrq_u8(vcltq_u8(chunk, vdupq_n_u8(0x20)), vcgeq_u8(chunk, vdupq_n_u8(0x7F)));
+                // Narrow each byte of the mask to four bits to get it into a general purpose register.
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+                if (mask != 0) return i + (__builtin_ctzll(mask) >> 2);
+        }
+#endif
+        for (; i < length && (data[i] >= 0x20 && data[i] < 0x7F); i++) {}
+        return i;
+}
+
+/** Result of decodeUtf8() for a sequence that is not valid UTF-8. */
+static constexpr int UTF8_INVALID = -1;
+/** Result of decodeUtf8() for a valid sequence that continues past the end of the data. */
+static constexpr int UTF8_INCOMPLETE = 0;
+
+/** Decode the UTF-8 sequence at the start of data, rejecting overlong encodings, surrogates and code points
+ * above U+10FFFF. Returns the length of the sequence with the code point stored in codepoint, or one of
+ * UTF8_INVALID (where the first byte should be replaced by U+FFFD) and UTF8_INCOMPLETE. */
+inline int decodeUtf8(uint8_t const* data, size_t length, uint32_t& codepoint) {
+        uint8_t first = data[0];
+        if (first < 0x80) {
+                codepoint = first;
+                return 1;
+        }
+        int sequenceLength;
+        // The allowed range of the second byte, which is narrower than the continuation bytes after certain first bytes.
+        uint8_t low = 0x80, high = 0xBF;
+        if (first >= 0xC2 && first <= 0xDF) {
+                sequenceLength = 2;
+                codepoint = first & 0x1F;
+        } else if (first >= 0xE0 && first <= 0xEF) {
+                sequenceLength = 3;
+                codepoint = first & 0x0F;
+                if (first == 0xE0) low = 0xA0; // Overlong.
+                else if (first == 0xED) high = 0x9F; // Surrogates.
+        } else if (first >= 0xF0 && first <= 0xF4) {
+                sequenceLength = 4;
+                codepoint = first & 0x07;
+                if (first == 0xF0) low = 0x90; // Overlong.
+                else if (first == 0xF4) high = 0x8F; // Above U+10FFFF.
+        } else {
+                return UTF8_INVALID;
+        }
+        for (int i = 1; i < sequenceLength; i++) {
+                if (size_t(i) >= length) return UTF8_INCOMPLETE;
+                uint8_t byte = data[i];
+                if (byte < low || byte > high) return UTF8_INVALID;
+                low = 0x80;
+                high = 0xBF;
+                codepoint = (codepoint << 6) | (byte & 0x3F);
+        }
+        return sequenceLength;
+}
+
+/** Return the length of the prefix of data that is printable text: printable ASCII and valid UTF-8 sequences
+ * that do not decode to C1 control characters. Stops before control characters, invalid UTF-8 and a
+ * sequence that is incomplete at the end of the data. */
+inline size_t scanText(uint8_t const* data, size_t length) {
+        size_t i = 0;
+        while (true) {
+                i += scanPrintableAscii(data + i, length - i);
+                if (i == length || data[i] < 0x80) return i;
+                uint32_t codepoint;
+                int sequenceLength = decodeUtf8(data + i, length - i, codepoint);
+                if (sequenceLength <= 0 || codepoint <= 0x9F) return i;
+                i += sequenceLength;
+        }
+}
+
+#endif
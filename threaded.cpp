@@ -0,0 +1,48 @@
+#include "threadedterminal.hpp"
+
+#include <unistd.h>
+
+// One thread redraws a spinner and another a counter as fast as they can, while the main thread waits for a key.
+// Only as many frames as the terminal keeps up with are presented.
+
+int main() {
+        FdIo io(STDIN_FILENO, STDOUT_FILENO);
+        ThreadedStats stats;
+        {
+                ThreadedTerminal term(io);
+                std::atomic<bool> quit{false};
+                term.configure([](Terminal& t) { t.enterAltScreen(); });
+                term.setCursor(0, 0, false);
+                std::thread spinner([&] {
+                        char const* const SPINNER[] = {"|", "/", "-", "\\"};
+                        for (unsigned int i = 0; !quit; i++) {
+                                unsigned int top = term.size().rows - 1;
+                                term.clear();
+                                term.drawText(2, top, Style(), "Press any key to quit");
+                                term.drawText(2, top - 2, Style(), SPINNER[i / 1000 % 4]);
+                                term.endFrame();
+                                usleep(100);
+                        }
+                });
+                std::thread counter([&] {
+                        for (unsigned long long i = 0; !quit; i++) {
+                                char line[80];
+                                snprintf(line, sizeof(line), "Updates: %llu", i);
+                                term.drawText(4, term.size().rows - 3, Style().withForeground(Style::basicColor(Color::GREEN)), line);
+                                usleep(10);
+                        }
+                });
+
+                Event event;
+                while (term.nextEvent(event)) {
+                        if (event.type == EventType::CHAR || event.type == EventType::KEY || event.type == EventType::INPUT_ENDED) break;
+                }
+                quit = true;
+                spinner.join();
+                counter.join();
+                stats = term.stats();
+        }
+        printf("Frames submitted: %llu, presented: %llu, merged: %llu, repainted: %llu\n", (unsigned long long) stats.framesSubmitted,
+                        (unsigned long long) stats.framesPresented, (unsigned long long) stats.framesMerged, (unsigned long long) stats.framesRepainted);
+        return 0;
+}
@@ -0,0 +1,291 @@
+#include "threadedterminal.hpp"
+#include "unicode.hpp"
+
+#include <algorithm>
+
+/** How often the input thread checks if it should stop while no input arrives, if its TerminalIo cannot be woken. */
+static const uint64_t INPUT_POLL_NANOS = 50 * 1000000ull;
+/** The longest the render thread keeps merging frames while producers keep the command ring from running empty. */
+static const uint64_t MAX_MERGE_NANOS = 50 * 1000000ull;
+static const size_t EVENT_CAPACITY = 1024;
+
+static uint64_t packSize(Size size) {
+        return (uint64_t(size.rows) << 32) | size.columns;
+}
+
+ThreadedTerminal::ThreadedTerminal(TerminalIo& io, bool textRuns, size_t commandCapacity)
+        : mInputIo(io), mOutputIo(io), mInputTerminal(mInputIo), mRenderTerminal(mOutputIo), mCommands(commandCapacity),
+          mEvents(EVENT_CAPACITY), mSize(packSize(mRenderTerminal.size())) {
+        mInputTerminal.setTextRuns(textRuns);
+        mRenderTerminal.setRetainedMode(true).setAutoPresent(false);
+        mInputThread = std::thread([this] { inputLoop(); });
+        mRenderThread = std::thread([this] { renderLoop(); });
+}
+
+ThreadedTerminal::~ThreadedTerminal() {
+        mStopping.store(true, std::memory_order_release);
+        mCommandsWakeUp.notify();
+        mEventSpaceWakeUp.notify();
+        mInputIo.wakeUp();
+        mRenderThread.join();
+        mInputThread.join();
+}
+
+bool ThreadedTerminal::push(DrawCommand const& command) {
+        if (!mCommands.push(command)) {
+                mRejected.fetch_add(1, std::memory_order_acq_rel);
+                return false;
+        }
+        mCommandsWakeUp.notify();
+        return true;
+}
+
+bool ThreadedTerminal::clear(Style style) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::CLEAR;
+        command.style = style;
+        command.value = mRejected.load(std::memory_order_acquire);
+        return push(command);
+}
+
+bool ThreadedTerminal::drawText(unsigned int column, unsigned int row, Style style, char const* text, size_t length) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::TEXT;
+        command.style = style;
+        command.row = uint16_t(row);
+        uint8_t const* bytes = (uint8_t const*) text;
+        size_t offset = 0;
+        bool pushed = true;
+        // Split at grapheme cluster boundaries, so that each piece can be printed on its own, with the column of the
+        // next piece after the width of the previous one.
+        while (offset < length) {
+                size_t pieceLength = 0;
+                unsigned int pieceWidth = 0;
+                while (offset + pieceLength < length) {
+                        unsigned int width;
+                        size_t graphemeLength = nextGrapheme(bytes + offset + pieceLength, length - offset - pieceLength, width);
+                        if (pieceLength + graphemeLength > DrawCommand::TEXT_CAPACITY) {
+                                // A cluster longer than a whole piece is left out.
+                                if (pieceLength == 0) offset += graphemeLength;
+                                break;
+                        }
+                        pieceLength += graphemeLength;
+                        pieceWidth += width;
+                }
+                if (pieceLength == 0) continue;
+                command.column = uint16_t(column);
+                command.length = uint8_t(pieceLength);
+                memcpy(command.text, bytes + offset, pieceLength);
+                pushed = push(command) && pushed;
+                offset += pieceLength;
+                column += pieceWidth;
+        }
+        return pushed;
+}
+
+bool ThreadedTerminal::fillRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, Style style, uint32_t codepoint) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::FILL_RECTANGLE;
+        command.column = uint16_t(column);
+        command.row = uint16_t(row);
+        command.columns = uint16_t(columns);
+        command.rows = uint16_t(rows);
+        command.style = style;
+        command.value = codepoint;
+        return push(command);
+}
+
+bool ThreadedTerminal::copyRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, unsigned int toColumn, unsigned int toRow) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::COPY_RECTANGLE;
+        command.column = uint16_t(column);
+        command.row = uint16_t(row);
+        command.columns = uint16_t(columns);
+        command.rows = uint16_t(rows);
+        command.toColumn = uint16_t(toColumn);
+        command.toRow = uint16_t(toRow);
+        return push(command);
+}
+
+bool ThreadedTerminal::setCursor(unsigned int column, unsigned int row, bool visible) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::CURSOR;
+        command.column = uint16_t(column);
+        command.row = uint16_t(row);
+        command.visible = visible;
+        return push(command);
+}
+
+bool ThreadedTerminal::configure(void (*function)(Terminal&)) {
+        DrawCommand command;
+        command.type = DrawCommand::Type::CONFIGURE;
+        command.configure = function;
+        return push(command);
+}
+
+bool ThreadedTerminal::endFrame() {
+        DrawCommand command;
+        command.type = DrawCommand::Type::END_FRAME;
+        if (!push(command)) return false;
+        mFramesSubmitted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+}
+
+bool ThreadedTerminal::nextEvent(Event& event, int timeoutMilliseconds) {
+        uint64_t deadline = timeoutMilliseconds < 0 ? UINT64_MAX : Terminal::monotonicNanos() + uint64_t(timeoutMilliseconds) * 1000000;
+        QueuedEvent queued;
+        while (!mEvents.pop(queued)) {
+                uint64_t now = Terminal::monotonicNanos();
+                if (now >= deadline) return false;
+                mEventsWakeUp.wait(deadline, now, [this] { return !mEvents.empty(); });
+        }
+        mEventSpaceWakeUp.notify();
+        event = queued.event;
+        if (event.type == EventType::TEXT || event.type == EventType::PASTE) {
+                memcpy(mEventText, queued.text, event.text.length);
+                event.text.data = mEventText;
+        }
+        return true;
+}
+
+ThreadedStats ThreadedTerminal::stats() const {
+        ThreadedStats stats;
+        stats.framesSubmitted = mFramesSubmitted.load(std::memory_order_relaxed);
+        stats.framesPresented = mFramesPresented.load(std::memory_order_relaxed);
+        stats.framesMerged = mFramesMerged.load(std::memory_order_relaxed);
+        stats.framesRepainted = mFramesRepainted.load(std::memory_order_relaxed);
+        stats.commandsRejected = mRejected.load(std::memory_order_relaxed);
+        return stats;
+}
+
+void ThreadedTerminal::inputLoop() {
+        bool wakeable = mInputIo.wakeable();
+        while (!mStopping.load(std::memory_order_acquire)) {
+                // The destructor wakes the wait up, so it need not time out to check for stopping.
+                EventType type = mInputTerminal.awaitUntil(wakeable ? UINT64_MAX : Terminal::monotonicNanos() + INPUT_POLL_NANOS);
+                if (type == EventType::TIMEOUT) continue;
+                Event const& event = mInputTerminal.lastEvent();
+                if (type == EventType::RESIZE) {
+                        mSize.store(packSize(event.size), std::memory_order_release);
+                        mResizePending.store(true, std::memory_order_release);
+                        mCommandsWakeUp.notify();
+                }
+                queueEvent(event);
+                // Nothing more can be read.
+                if (type == EventType::INPUT_ENDED) break;
+        }
+}
+
+void ThreadedTerminal::queueEvent(Event const& event) {
+        QueuedEvent queued;
+        queued.event = event;
+        bool hasText = (event.type == EventType::TEXT || event.type == EventType::PASTE);
+        size_t offset = 0;
+        do {
+                if (hasText) {
+                        // Split long text where a UTF-8 sequence starts, with only the last piece of a paste finishing it.
+                        size_t length = std::min(event.text.length - offset, QueuedEvent::TEXT_CAPACITY);
+                        if (offset + length < event.text.length) {
+                                size_t boundary = length;
+                                while (boundary > 0 && (event.text.data[offset + boundary] & 0xC0) == 0x80) boundary--;
+                                if (boundary > 0) length = boundary;
+                        }
+                        memcpy(queued.text, event.text.data + offset, length);
+                        queued.event.text = ByteSpan{nullptr, length};
+                        offset += length;
+                        queued.event.pasteFinished = event.pasteFinished && offset == event.text.length;
+                }
+                // Input is not dropped, so wait for the consumer when it falls behind.
+                while (!mEvents.push(queued)) {
+                        if (mStopping.load(std::memory_order_acquire)) return;
+                        // nextEvent() and the destructor notify when there is space or it is time to stop.
+                        mEventSpaceWakeUp.wait(UINT64_MAX, 0, [this] {
+                                return !mEvents.full() || mStopping.load(std::memory_order_acquire);
+                        });
+                }
+                mEventsWakeUp.notify();
+        } while (offset < event.text.length && hasText);
+}
+
+void ThreadedTerminal::renderLoop() {
+        unsigned int frames = 0;
+        uint64_t firstFrameTime = 0;
+        while (true) {
+                if (mResizePending.exchange(false, std::memory_order_acq_rel)) mRenderTerminal.updateSize();
+                DrawCommand command;
+                bool popped = false;
+                while (mCommands.pop(command)) {
+                        popped = true;
+                        apply(command);
+                        if (command.type != DrawCommand::Type::END_FRAME) continue;
+                        uint64_t now = Terminal::monotonicNanos();
+                        if (frames++ == 0) firstFrameTime = now;
+                        // Present what has been drawn up to this frame end, unless the next frame has already been started,
+                        // in which case this one is stale, as long as the frames have not been held back for too long.
+                        if (!mCommands.ready() || now - firstFrameTime >= MAX_MERGE_NANOS) {
+                                present(frames);
+                                frames = 0;
+                                if (mStopping.load(std::memory_order_acquire)) break;
+                        }
+                }
+                // Frames that are still coming in when stopping are left out.
+                if (mStopping.load(std::memory_order_acquire)) break;
+                if (popped) continue;
+                // The end of the last frame was held back for a next one whose end was then rejected.
+                if (frames > 0) {
+                        present(frames);
+                        frames = 0;
+                }
+                mCommandsWakeUp.wait(UINT64_MAX, 0, [this] {
+                        return mCommands.ready() || mResizePending.load(std::memory_order_acquire) || mStopping.load(std::memory_order_acquire);
+                });
+        }
+}
+
+void ThreadedTerminal::apply(DrawCommand const& command) {
+        Terminal& t = mRenderTerminal;
+        switch (command.type) {
+                case DrawCommand::Type::CLEAR:
+                        t.setStyle(command.style).clear();
+                        mKeyframeRejected.store(command.value, std::memory_order_release);
+                        break;
+                case DrawCommand::Type::TEXT:
+                        if (command.column >= t.columns()) break;
+                        t.setStyle(command.style).placeCursor(command.column, command.row);
+                        t.printClipped(t.columns() - command.column, "%.*s", int(command.length), command.text);
+                        break;
+                case DrawCommand::Type::FILL_RECTANGLE:
+                        t.setStyle(command.style).fillRectangle(command.column, command.row, command.columns, command.rows, command.value);
+                        break;
+                case DrawCommand::Type::COPY_RECTANGLE:
+                        t.copyRectangle(command.column, command.row, command.columns, command.rows, command.toColumn, command.toRow);
+                        break;
+                case DrawCommand::Type::CURSOR:
+                        t.placeCursor(command.column, command.row);
+                        if (command.visible != mCursorVisible) {
+                                if (command.visible) t.showCursor(); else t.hideCursor();
+                                mCursorVisible = command.visible;
+                        }
+                        break;
+                case DrawCommand::Type::CONFIGURE:
+                        command.configure(t);
+                        t.flush();
+                        break;
+                case DrawCommand::Type::END_FRAME:
+                        break;
+        }
+}
+
+void ThreadedTerminal::present(unsigned int frames) {
+        // Commands lost since the last present() may have left a frame half drawn, such as text that was to be copied
+        // elsewhere, so send every cell instead of only the changed ones of a canvas that may not match the screen.
+        uint32_t rejected = mRejected.load(std::memory_order_acquire);
+        if (rejected != mRepaintedRejected) {
+                mRenderTerminal.repaint();
+                mRepaintedRejected = rejected;
+                mFramesRepainted.fetch_add(1, std::memory_order_relaxed);
+        }
+        mRenderTerminal.present().flush();
+        mFramesPresented.fetch_add(1, std::memory_order_relaxed);
+        mFramesMerged.fetch_add(frames - 1, std::memory_order_relaxed);
+}
@@ -0,0 +1,159 @@
+#ifndef THREADEDTERMINAL_HPP_INCLUDED
+#define THREADEDTERMINAL_HPP_INCLUDED
+
+#include "concurrentqueues.hpp"
+#include "screencanvas.hpp"
+
+#include <thread>
+
+/** Counters of what a ThreadedTerminal has done. */
+struct ThreadedStats {
+        /** Frames ended with endFrame() by producers. */
+        uint64_t framesSubmitted{0};
+        /** Frames sent to the terminal. When the terminal falls behind, all frames that have arrived meanwhile are
+         * presented as one, and all but the last of them are counted as merged. */
+        uint64_t framesPresented{0};
+        uint64_t framesMerged{0};
+        /** Frames presented by repainting the whole screen, since commands had been rejected since the previous one. */
+        uint64_t framesRepainted{0};
+        /** Commands that were rejected since the command queue was full. */
+        uint64_t commandsRejected{0};
+};
+
+/** A draw command on its way from a producer to the render thread. Longer text is split into several commands. */
+struct DrawCommand {
+        enum class Type : uint8_t { CLEAR, TEXT, FILL_RECTANGLE, COPY_RECTANGLE, CURSOR, CONFIGURE, END_FRAME };
+        static constexpr size_t TEXT_CAPACITY = 40;
+
+        Type type{Type::END_FRAME};
+        uint8_t length{0};
+        bool visible{false};
+        uint16_t column{0}, row{0}, columns{0}, rows{0}, toColumn{0}, toRow{0};
+        /** For FILL_RECTANGLE, the character. For CLEAR, the number of rejected commands when it was pushed, which only needs to
+         * tell if there have been more since. */
+        uint32_t value{0};
+        Style style;
+        void (*configure)(Terminal&){nullptr};
+        char text[TEXT_CAPACITY];
+};
+
+/** A Terminal that any number of threads can draw on without ever blocking on a slow terminal. A render thread owns the
+ * output and a Terminal in retained mode, and an input thread owns the input and runs the parser of another Terminal.
+ * Producers push draw commands on a lock-free ring that the render thread applies, and end each frame with endFrame().
+ * Whenever the render thread has caught up with the ring, it presents what it has applied up to the last frame end, so
+ * that the frames that arrived while it was writing are merged into one instead of sent one by one. If the ring is
+ * full, commands are rejected rather than waited for. Presenting goes on, but the next frame repaints the whole screen,
+ * so that what was shown before is not left mixed with a half drawn frame, and needsKeyframe() tells producers that the
+ * missing parts should be drawn again from a clear(). Events are passed to a single consumer on another queue.
+ *
+ * Rows and columns are as for Terminal, with row 0 at the bottom. With several producers each frame end presents what
+ * all of them have drawn so far, so they should either draw disjoint parts of the screen or agree on who ends frames. */
+class ThreadedTerminal {
+        public:
+                /** Start the threads on io, which must outlive this. Input is parsed with Terminal::setTextRuns(textRuns). */
+                explicit ThreadedTerminal(TerminalIo& io, bool textRuns = false, size_t commandCapacity = 16384);
+                ~ThreadedTerminal();
+
+                /** Clear the screen to the background of style, which also starts a keyframe. */
+                bool clear(Style style = Style());
+                /** Print UTF-8 text without line breaks, with the first grapheme cluster at column, row. */
+                bool drawText(unsigned int column, unsigned int row, Style style, char const* text, size_t length);
+                bool drawText(unsigned int column, unsigned int row, Style style, char const* text) { return drawText(column, row, style, text, strlen(text)); }
+                bool fillRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, Style style, uint32_t codepoint);
+                bool copyRectangle(unsigned int column, unsigned int row, unsigned int columns, unsigned int rows, unsigned int toColumn, unsigned int toRow);
+                /** Where the cursor is left after each frame, and if it is shown. */
+                bool setCursor(unsigned int column, unsigned int row, bool visible);
+                /** Call a function with the Terminal on the render thread, such as to enable the mouse or set capabilities. */
+                bool configure(void (*function)(Terminal&));
+                bool endFrame();
+
+                /** If commands have been rejected since the last clear() was pushed, so that parts of the screen may be missing until redrawn from scratch. */
+                bool needsKeyframe() const { return mRejected.load(std::memory_order_acquire) != mKeyframeRejected.load(std::memory_order_acquire); }
+                /** The latest size reported by the terminal. Producers should redraw at the new size on a RESIZE event. */
+                Size size() const { uint64_t size = mSize.load(std::memory_order_acquire); return Size{unsigned(size >> 32), unsigned(size)}; }
+
+                /** Wait for the next input event, returning false if none arrived within the timeout, where a negative
+                 * timeout means waiting forever. The text of TEXT and PASTE events is valid until the next call. Only one
+                 * thread may call this. After an INPUT_ENDED event no more events arrive. */
+                bool nextEvent(Event& event, int timeoutMilliseconds = -1);
+
+                ThreadedStats stats() const;
+
+        private:
+                /** Forwards input and size to the real TerminalIo, while output is discarded. */
+                class InputIo : public TerminalIo {
+                        public:
+                                explicit InputIo(TerminalIo& io) : mIo(io) {}
+                                unsigned int wait(uint64_t deadline) override { return mIo.wait(deadline); }
+                                ssize_t read(uint8_t* buffer, size_t capacity) override { return mIo.read(buffer, capacity); }
+                                unsigned int write(char const*, size_t length, size_t& written) override { written = length; return 0; }
+                                bool size(Size& size) override { return mIo.size(size); }
+                                void setRawMode(bool raw) override { mIo.setRawMode(raw); }
+                                char const* environment(char const* name) override { return mIo.environment(name); }
+                                bool wakeable() const override { return mIo.wakeable(); }
+                                void wakeUp() override { mIo.wakeUp(); }
+                        private:
+                                TerminalIo& mIo;
+                };
+
+                /** Forwards output and size to the real TerminalIo, while there is never any input. */
+                class OutputIo : public TerminalIo {
+                        public:
+                                explicit OutputIo(TerminalIo& io) : mIo(io) {}
+                                unsigned int wait(uint64_t) override { return 0; }
+                                ssize_t read(uint8_t*, size_t) override { return 0; }
+                                unsigned int write(char const* data, size_t length, size_t& written) override { return mIo.write(data, length, written); }
+                                bool size(Size& size) override { return mIo.size(size); }
+                                char const* environment(char const* name) override { return mIo.environment(name); }
+                        private:
+                                TerminalIo& mIo;
+                };
+
+                /** An event with its text, which is split into several events if longer than fits. */
+                struct QueuedEvent {
+                        static constexpr size_t TEXT_CAPACITY = 64;
+                        Event event;
+                        uint8_t text[TEXT_CAPACITY];
+                };
+
+                InputIo mInputIo;
+                OutputIo mOutputIo;
+                /** Only used by the input thread, and the render thread respectively, once started. */
+                Terminal mInputTerminal;
+                Terminal mRenderTerminal;
+
+                MpscRing<DrawCommand> mCommands;
+                WakeUp mCommandsWakeUp;
+                SpscQueue<QueuedEvent> mEvents;
+                WakeUp mEventsWakeUp;
+                /** The input thread waits on this when the event queue is full. */
+                WakeUp mEventSpaceWakeUp;
+                uint8_t mEventText[QueuedEvent::TEXT_CAPACITY];
+                bool mCursorVisible{true};
+
+                std::atomic<bool> mStopping{false};
+                std::atomic<bool> mResizePending{false};
+                /** Rows in the high and columns in the low 32 bits. */
+                std::atomic<uint64_t> mSize;
+                /** The number of rejected commands, and that number as it was when the last applied keyframe was pushed. */
+                std::atomic<uint32_t> mRejected{0};
+                std::atomic<uint32_t> mKeyframeRejected{0};
+                std::atomic<uint64_t> mFramesSubmitted{0};
+                std::atomic<uint64_t> mFramesPresented{0};
+                std::atomic<uint64_t> mFramesMerged{0};
+                std::atomic<uint64_t> mFramesRepainted{0};
+                /** The number of rejected commands when the render thread last repainted. */
+                uint32_t mRepaintedRejected{0};
+
+                std::thread mInputThread;
+                std::thread mRenderThread;
+
+                bool push(DrawCommand const& command);
+                void inputLoop();
+                void queueEvent(Event const& event);
+                void renderLoop();
+                void apply(DrawCommand const& command);
+                void present(unsigned int frames);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "framescheduler.hpp"
+
+// Updates a counter a thousand times per second while only presenting it at most 30 times per second.
+
+int main() {
+        unsigned int updates = 0;
+        Terminal term;
+        term.enterAltScreen().hideCursor();
+        FrameScheduler scheduler(term, 30, [&](Terminal& t) {
+                FrameStats const& stats = scheduler.stats();
+                t.clear();
+                t.placeCursor(2, t.rows() - 2).print("Updates: %u", updates);
+                t.placeCursor(2, t.rows() - 3).print("Frames presented: %llu, skipped: %llu, late: %llu, dropped: %llu",
+                                (unsigned long long) stats.presented, (unsigned long long) stats.skipped,
+                                (unsigned long long) stats.late, (unsigned long long) stats.dropped);
+                unsigned int width = t.columns() - 4;
+                t.placeCursor(2, t.rows() - 5).setBackground(Color::BLUE);
+                for (unsigned int i = 0; i < (updates / 10) % width; i++) t.print(" ");
+                t.resetColorsAndStyle().placeCursor(2, 1).print("Press any key to quit");
+        });
+
+        while (true) {
+                EventType event = scheduler.await(1);
+                if (event == EventType::TIMEOUT) {
+                        updates++;
+                        scheduler.requestFrame();
+                } else if (event == EventType::CHAR || event == EventType::KEY || event == EventType::INPUT_ENDED) {
+                        break;
+                }
+        }
+        return 0;
+}
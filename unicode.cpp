@@ -0,0 +1,199 @@
+#include "unicode.hpp"
+#include "textscan.hpp"
+
+namespace {
+        struct UnicodeRange {
+                uint32_t first;
+                uint32_t last;
+                uint8_t width;
+                GraphemeBreak graphemeBreak;
+        };
+
+        constexpr size_t BLOCKS = 0x110000 >> 8;
+
+        constexpr uint8_t properties(unsigned int width, GraphemeBreak graphemeBreak) { return uint8_t(width | (unsigned(graphemeBreak) << 2)); }
+
+        constexpr uint8_t rangeProperties(UnicodeRange const& range, uint32_t codepoint) {
+                // The LV syllables are the first of each 28, which have no final consonant.
+                if (range.graphemeBreak == GraphemeBreak::LVT && codepoint >= 0xAC00 && codepoint <= 0xD7A3 && (codepoint - 0xAC00) % 28 == 0) {
+                        return properties(range.width, GraphemeBreak::LV);
+                }
+                return properties(range.width, range.graphemeBreak);
+        }
+
+        /** Finds the distinct blocks of code points. Blocks where all code points have the same properties are common, so
+         * those are recognized from the ranges without looking at each code point, to stay within the limits of constexpr. */
+        struct TableBuilder {
+                uint8_t blockIndex[BLOCKS]{};
+                uint8_t blocks[256][256]{};
+                size_t count{0};
+
+                constexpr TableBuilder(UnicodeRange const* ranges, size_t rangeCount) {
+                        // For each distinct block, a hash of it and the properties of all of its code points if uniform or else -1.
+                        uint32_t hashes[256]{};
+                        int uniforms[256]{};
+                        size_t range = 0;
+                        uint8_t entries[256]{};
+                        for (size_t block = 0; block < BLOCKS; block++) {
+                                uint32_t first = uint32_t(block) << 8, last = first + 255;
+                                while (range < rangeCount && ranges[range].last < first) range++;
+                                int uniform = -1;
+                                uint32_t hash = 0;
+                                if (range == rangeCount || ranges[range].first > last) {
+                                        uniform = properties(1, GraphemeBreak::OTHER);
+                                } else if (ranges[range].first <= first && ranges[range].last >= last && ranges[range].graphemeBreak != GraphemeBreak::LVT) {
+                                        uniform = rangeProperties(ranges[range], first);
+                                } else {
+                                        for (size_t i = 0; i < 256; i++) entries[i] = properties(1, GraphemeBreak::OTHER);
+                                        for (size_t r = range; r < rangeCount && ranges[r].first <= last; r++) {
+                                                uint32_t from = ranges[r].first < first ? first : ranges[r].first;
+                                                uint32_t to = ranges[r].last > last ? last : ranges[r].last;
+                                                for (uint32_t codepoint = from; codepoint <= to; codepoint++) entries[codepoint - first] = rangeProperties(ranges[r], codepoint);
+                                        }
+                                        hash = 2166136261u;
+                                        for (size_t i = 0; i < 256; i++) hash = (hash ^ entries[i]) * 16777619u;
+                                }
+
+                                size_t index = 0;
+                                for (; index < count; index++) {
+                                        if (uniforms[index] != uniform || hashes[index] != hash) continue;
+                                        if (uniform >= 0 || sameBlock(blocks[index], entries)) break;
+                                }
+                                if (index == count) {
+                                        if (count == 256) throw "More than 256 distinct blocks, so indices do not fit in uint8_t";
+                                        hashes[index] = hash;
+                                        uniforms[index] = uniform;
+                                        for (size_t i = 0; i < 256; i++) blocks[index][i] = uniform >= 0 ? uint8_t(uniform) : entries[i];
+                                        count++;
+                                }
+                                blockIndex[block] = uint8_t(index);
+                        }
+                }
+
+                static constexpr bool sameBlock(uint8_t const (&a)[256], uint8_t const (&b)[256]) {
+                        for (size_t i = 0; i < 256; i++) if (a[i] != b[i]) return false;
+                        return true;
+                }
+        };
+
+        constexpr UnicodeTables buildTables() {
+                UnicodeRange const ranges[] = {
+#include "unicoderanges.hpp"
+                };
+                TableBuilder builder(ranges, sizeof(ranges) / sizeof(ranges[0]));
+                if (builder.count != UNICODE_BLOCK_COUNT) throw "UNICODE_BLOCK_COUNT in unicode.hpp must be the number of distinct blocks";
+
+                UnicodeTables tables{};
+                for (size_t block = 0; block < BLOCKS; block++) tables.blockIndex[block] = builder.blockIndex[block];
+                for (size_t index = 0; index < UNICODE_BLOCK_COUNT; index++) {
+                        for (size_t i = 0; i < 256; i++) tables.blocks[index][i] = builder.blocks[index][i];
+                }
+                return tables;
+        }
+
+        /** Decode the code point at the start of text, taking invalid or incomplete UTF-8 to be U+FFFD one byte at a time. */
+        size_t decodeOrReplace(uint8_t const* text, size_t length, uint32_t& codepoint) {
+                int sequenceLength = decodeUtf8(text, length, codepoint);
+                if (sequenceLength > 0) return sequenceLength;
+                codepoint = 0xFFFD;
+                return 1;
+        }
+}
+
+extern constexpr UnicodeTables UNICODE_TABLES = buildTables();
+
+size_t nextGrapheme(uint8_t const* text, size_t length, unsigned int& width) {
+        uint32_t codepoint;
+        size_t position = decodeOrReplace(text, length, codepoint);
+        GraphemeBreak previous = graphemeBreak(codepoint);
+        GraphemeBreak first = previous;
+        width = codepointWidth(codepoint);
+        // Break after controls (GB4), except between CR and LF (GB3).
+        if (previous == GraphemeBreak::CR && position < length && text[position] == '\n') return position + 1;
+        if (previous == GraphemeBreak::CONTROL || previous == GraphemeBreak::CR || previous == GraphemeBreak::LF) return position;
+        // No ASCII character extends a cluster, except after a prepended mark.
+        if (position < length && text[position] < 0x80 && previous != GraphemeBreak::PREPEND) return position;
+
+        // If the cluster so far is an emoji followed by extenders, and if that is followed by a zero width joiner (GB11).
+        bool pictographic = previous == GraphemeBreak::EXTENDED_PICTOGRAPHIC;
+        bool pictographicJoiner = false;
+        unsigned int regionalIndicators = previous == GraphemeBreak::REGIONAL_INDICATOR ? 1 : 0;
+        while (position < length) {
+                size_t nextLength = decodeOrReplace(text + position, length - position, codepoint);
+                GraphemeBreak next = graphemeBreak(codepoint);
+                bool join;
+                switch (next) {
+                        case GraphemeBreak::CONTROL: case GraphemeBreak::CR: case GraphemeBreak::LF:
+                                join = false; // GB5
+                                break;
+                        case GraphemeBreak::EXTEND: case GraphemeBreak::ZWJ: case GraphemeBreak::SPACING_MARK:
+                                join = true; // GB9, GB9a
+                                break;
+                        default:
+                                if (previous == GraphemeBreak::PREPEND) {
+                                        join = true; // GB9b
+                                } else if (previous == GraphemeBreak::L) {
+                                        join = next == GraphemeBreak::L || next == GraphemeBreak::V || next == GraphemeBreak::LV || next == GraphemeBreak::LVT; // GB6
+                                } else if (previous == GraphemeBreak::LV || previous == GraphemeBreak::V) {
+                                        join = next == GraphemeBreak::V || next == GraphemeBreak::T; // GB7
+                                } else if (previous == GraphemeBreak::LVT || previous == GraphemeBreak::T) {
+                                        join = next == GraphemeBreak::T; // GB8
+                                } else if (previous == GraphemeBreak::ZWJ) {
+                                        join = pictographicJoiner && next == GraphemeBreak::EXTENDED_PICTOGRAPHIC; // GB11
+                                } else {
+                                        join = previous == GraphemeBreak::REGIONAL_INDICATOR && next == GraphemeBreak::REGIONAL_INDICATOR
+                                                && regionalIndicators % 2 == 1; // GB12, GB13
+                                }
+                                break;
+                }
+                if (!join) break;
+
+                pictographicJoiner = pictographic && next == GraphemeBreak::ZWJ;
+                if (next == GraphemeBreak::EXTENDED_PICTOGRAPHIC) {
+                        pictographic = true;
+                } else if (next != GraphemeBreak::EXTEND) {
+                        pictographic = false;
+                }
+                if (next == GraphemeBreak::REGIONAL_INDICATOR) {
+                        // A pair of regional indicators is a flag.
+                        regionalIndicators++;
+                        width = 2;
+                }
+                // An emoji presentation selector makes an emoji that would be shown as text wide.
+                if (codepoint == 0xFE0F && first == GraphemeBreak::EXTENDED_PICTOGRAPHIC) width = 2;
+                if (width == 0) width = codepointWidth(codepoint);
+                previous = next;
+                position += nextLength;
+        }
+        return position;
+}
+
+size_t textWidth(char const* text, size_t length) {
+        size_t width;
+        clipToWidth(text, length, SIZE_MAX, width);
+        return width;
+}
+
+size_t clipToWidth(char const* text, size_t length, size_t maxWidth, size_t& width) {
+        uint8_t const* bytes = (uint8_t const*) text;
+        size_t position = 0;
+        width = 0;
+        while (position < length && width < maxWidth) {
+                // Printable ASCII characters are clusters of width 1 by themselves, except that the last one before
+                // non-ASCII may be followed by combining marks.
+                size_t ascii = scanPrintableAscii(bytes + position, length - position);
+                if (ascii > 0 && position + ascii < length && bytes[position + ascii] >= 0x80) ascii--;
+                if (ascii > 0) {
+                        if (ascii > maxWidth - width) ascii = maxWidth - width;
+                        position += ascii;
+                        width += ascii;
+                        continue;
+                }
+                unsigned int graphemeWidth;
+                size_t graphemeLength = nextGrapheme(bytes + position, length - position, graphemeWidth);
+                if (graphemeWidth > maxWidth - width) break;
+                position += graphemeLength;
+                width += graphemeWidth;
+        }
+        return position;
+}
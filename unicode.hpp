@@ -0,0 +1,48 @@
+#ifndef UNICODE_HPP_INCLUDED
+#define UNICODE_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** The Grapheme_Cluster_Break property of UAX #29, with Extended_Pictographic as a class of its own since
+ * it only occurs together with OTHER. */
+enum class GraphemeBreak : uint8_t { OTHER, CR, LF, CONTROL, EXTEND, ZWJ, REGIONAL_INDICATOR, PREPEND, SPACING_MARK, L, V, T, LV, LVT, EXTENDED_PICTOGRAPHIC };
+
+/** The number of distinct blocks of 256 code points in UnicodeTables, which unicode.cpp checks against the data. */
+static const size_t UNICODE_BLOCK_COUNT = 118;
+
+/** The properties of every code point as a two level table, built at compile time in unicode.cpp. The high bits of
+ * a code point select one of the distinct blocks, whose entry for the low 8 bits has the width in bits 0-1 and the
+ * GraphemeBreak in bits 2-5. */
+struct UnicodeTables {
+        uint8_t blockIndex[0x110000 >> 8];
+        uint8_t blocks[UNICODE_BLOCK_COUNT][256];
+};
+extern const UnicodeTables UNICODE_TABLES;
+
+inline uint8_t unicodeProperties(uint32_t codepoint) {
+        if (codepoint > 0x10FFFF) return 1;
+        return UNICODE_TABLES.blocks[UNICODE_TABLES.blockIndex[codepoint >> 8]][codepoint & 0xFF];
+}
+
+/** The number of columns a code point takes up: 0 for combining marks, format and control characters, 2 for
+ * East Asian wide and fullwidth characters and 1 for the rest. */
+inline unsigned int codepointWidth(uint32_t codepoint) { return unicodeProperties(codepoint) & 3; }
+inline GraphemeBreak graphemeBreak(uint32_t codepoint) { return GraphemeBreak(unicodeProperties(codepoint) >> 2); }
+
+/** Find the extended grapheme cluster at the start of the UTF-8 text, returning its length in bytes and storing
+ * the number of columns it takes up in width. A cluster is as wide as its first code point that has a width, except
+ * that an emoji presentation selector or a pair of regional indicators (a flag) makes it 2. Invalid UTF-8 is taken
+ * to be U+FFFD, one byte at a time. */
+size_t nextGrapheme(uint8_t const* text, size_t length, unsigned int& width);
+
+/** The number of columns the UTF-8 text takes up. Runs of printable ASCII are counted 16 bytes at a time. */
+size_t textWidth(char const* text, size_t length);
+inline size_t textWidth(char const* text) { return textWidth(text, strlen(text)); }
+
+/** The length in bytes of the longest prefix of the UTF-8 text that takes up at most maxWidth columns without
+ * splitting a grapheme cluster, with the number of columns it takes up stored in width. */
+size_t clipToWidth(char const* text, size_t length, size_t maxWidth, size_t& width);
+
+#endif
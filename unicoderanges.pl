@@ -0,0 +1,53 @@
+#!/usr/bin/perl
+# Generates unicoderanges.hpp from the Unicode Character Database that comes with Perl:
+#
+#     perl unicoderanges.pl > unicoderanges.hpp
+#
+# Each line is a range of code points whose width or grapheme cluster break class differs from the
+# default of width 1 and GraphemeBreak::OTHER. unicode.cpp builds its lookup table from them at compile time.
+use strict;
+use warnings;
+use Unicode::UCD;
+
+my @classes = (['CR', 'CR'], ['LF', 'LF'], ['CN', 'CONTROL'], ['EX', 'EXTEND'], ['ZWJ', 'ZWJ'], ['RI', 'REGIONAL_INDICATOR'],
+        ['PP', 'PREPEND'], ['SM', 'SPACING_MARK'], ['L', 'L'], ['V', 'V'], ['T', 'T'], ['LV', 'LV'], ['LVT', 'LVT']);
+
+sub properties {
+        my ($codepoint) = @_;
+        # Hangul syllables alternate between LV and LVT, so they are given as one LVT range that unicode.cpp picks the LV out of.
+        return (2, 'LVT') if $codepoint >= 0xAC00 && $codepoint <= 0xD7A3;
+        my $c = chr($codepoint);
+        my $class = 'OTHER';
+        for my $entry (@classes) {
+                if ($c =~ /\p{GCB=$entry->[0]}/) {
+                        $class = $entry->[1];
+                        last;
+                }
+        }
+        $class = 'EXTENDED_PICTOGRAPHIC' if $class eq 'OTHER' && $c =~ /\p{Extended_Pictographic}/;
+
+        my $width = 1;
+        if ($c =~ /[\p{Mn}\p{Me}\p{Cf}\p{Cc}\p{Cs}]/ && $codepoint != 0xAD && $class ne 'PREPEND') {
+                # Combining marks, format and control characters, except the soft hyphen and the prepended
+                # concatenation marks which are visible.
+                $width = 0;
+        } elsif ($class eq 'V' || $class eq 'T') {
+                # Medial vowels and final consonants of conjoining jamo.
+                $width = 0;
+        } elsif ($c =~ /[\p{EA=W}\p{EA=F}]/) {
+                $width = 2;
+        }
+        return ($width, $class);
+}
+
+printf "// Generated by unicoderanges.pl from Unicode %s - do not edit.\n", Unicode::UCD::UnicodeVersion();
+my ($start, $previous) = (0, undef);
+for my $codepoint (0 .. 0x110000) {
+        my $value = $codepoint == 0x110000 ? '' : join(',', properties($codepoint));
+        next if defined $previous && $value eq $previous;
+        if (defined $previous && $previous ne '1,OTHER') {
+                my ($width, $class) = split(',', $previous);
+                printf "{ 0x%04X, 0x%04X, %d, GraphemeBreak::%s },\n", $start, $codepoint - 1, $width, $class;
+        }
+        ($start, $previous) = ($codepoint, $value);
+}